@@ -2,7 +2,6 @@
 #include <format>
 
 #define UTF8_ENCODING_BYTE_COUNT(B) utf8_encoding_sizes[((uint8_t)(B)) >> 4]
-#define UTF8_IS_CONTINUATION_BYTE(B) (((B) & 0xC0) == 0x80)
 
 namespace brex
 {
@@ -163,7 +162,8 @@ namespace brex
     RegexChar UnicodeRegexIterator::toRegexCharCodeFromBytes() const
     {
         int64_t bytecount = UTF8_ENCODING_BYTE_COUNT(this->sstr->at(this->curr));
-        if(this->curr + (bytecount - 1) > this->epos) {
+        //epos can be any byte of the last char in the range (match positions are the first byte of a char) so only a char cut off by the end of the string is invalid
+        if(this->curr + (bytecount - 1) >= (int64_t)this->sstr->size()) {
             return 0;
         }
 
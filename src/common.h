@@ -19,6 +19,7 @@ typedef nlohmann::json json;
 
 #define UTF8_IS_SINGLEBYTE_ENCODING(byte) (((byte) & 0b10000000) == 0)
 #define UTF8_IS_MULTIBYTE_ENCODING(byte) (((byte) & 0b10000000) != 0)
+#define UTF8_IS_CONTINUATION_BYTE(byte) (((byte) & 0b11000000) == 0b10000000)
 
 #define UTF8_CHARCODE_USES_SINGLEBYTE_ENCODING(cc) ((cc) <= 0x7F)
 #define UTF8_CHARCODE_USES_MULTIBYTE_ENCODING(cc) ((cc) > 0x7F)
@@ -75,7 +76,8 @@ namespace brex
             return (this->spos <= this->curr) & (this->curr <= this->epos);
         }
 
-        inline void inc()
+        //the stepping methods are forced inline as the engines call them in their inner loops (and the multibyte paths otherwise make them look too big to inline)
+        inline __attribute__((always_inline)) void inc()
         {
             //if this is a multibyte char then advance by the number of bytes -- fast path on single byte
             if(UTF8_IS_SINGLEBYTE_ENCODING(this->sstr->at(this->curr))) {
@@ -86,18 +88,22 @@ namespace brex
             }
         }
 
-        inline void dec()
+        //reverse stepping keeps curr on the first byte of a char (so get works the same in both directions)
+        inline __attribute__((always_inline)) void dec()
         {
-            //if this is a multibyte char then advance by the number of bytes -- fast path on single byte
-            if(UTF8_IS_SINGLEBYTE_ENCODING(this->sstr->at(this->curr))) {
-                this->curr--;
-            }
-            else {
+            this->curr--;
+            this->toCharStart();
+        }
+
+        //move back to the first byte of the char that curr is in -- fast path on single byte
+        inline __attribute__((always_inline)) void toCharStart()
+        {
+            if(this->curr >= 0 && UTF8_IS_CONTINUATION_BYTE(this->sstr->at(this->curr))) {
                 this->curr -= this->charCodeByteCountReverse();
             }
         }
 
-        inline RegexChar get() const
+        inline __attribute__((always_inline)) RegexChar get() const
         {
             //if this is a multibyte char then decode the number of bytes -- fast path on single byte
             if(UTF8_CHARCODE_USES_SINGLEBYTE_ENCODING(this->sstr->at(this->curr))) {
@@ -135,17 +141,22 @@ namespace brex
             return (this->spos <= this->curr) & (this->curr <= this->epos);
         }
 
-        inline void inc()
+        inline __attribute__((always_inline)) void inc()
         {
             this->curr++;
         }
 
-        inline void dec()
+        inline __attribute__((always_inline)) void dec()
         {
             this->curr--;
         }
 
-        inline RegexChar get() const
+        inline __attribute__((always_inline)) void toCharStart()
+        {
+            ;
+        }
+
+        inline __attribute__((always_inline)) RegexChar get() const
         {
             return (RegexChar)this->sstr->at(this->curr);
         }
@@ -0,0 +1,305 @@
+#include "bitparallel_machine.h"
+
+#include "brex.h"
+
+#include <algorithm>
+
+namespace brex
+{
+    //first/last positions and nullability of a regex (sub)term in the Glushkov construction
+    class GlushkovTermInfo
+    {
+    public:
+        bool nullable;
+        std::vector<size_t> first;
+        std::vector<size_t> last;
+
+        GlushkovTermInfo() : nullable(true), first(), last() {;}
+        GlushkovTermInfo(bool nullable, std::vector<size_t> first, std::vector<size_t> last) : nullable(nullable), first(first), last(last) {;}
+        ~GlushkovTermInfo() = default;
+
+        GlushkovTermInfo(const GlushkovTermInfo& other) = default;
+        GlushkovTermInfo(GlushkovTermInfo&& other) = default;
+
+        GlushkovTermInfo& operator=(const GlushkovTermInfo& other) = default;
+        GlushkovTermInfo& operator=(GlushkovTermInfo&& other) = default;
+    };
+
+    class GlushkovBuilder
+    {
+    private:
+        static std::vector<size_t> unionPositions(const std::vector<size_t>& p1, const std::vector<size_t>& p2)
+        {
+            std::vector<size_t> res;
+            std::set_union(p1.cbegin(), p1.cend(), p2.cbegin(), p2.cend(), std::back_inserter(res));
+
+            return res;
+        }
+
+        void addFollows(const std::vector<size_t>& from, const std::vector<size_t>& to)
+        {
+            for(auto iter = from.cbegin(); iter != from.cend(); ++iter) {
+                std::copy(to.cbegin(), to.cend(), std::back_inserter(this->follows[*iter]));
+            }
+        }
+
+        size_t addPosition(NFAOpt* pred)
+        {
+            if(this->positions.size() >= BITPARALLEL_MAX_POSITIONS) {
+                this->overflow = true;
+            }
+
+            this->positions.push_back(pred);
+            this->follows.push_back({});
+
+            return this->positions.size() - 1;
+        }
+
+        GlushkovTermInfo concat(const GlushkovTermInfo& t1, const GlushkovTermInfo& t2)
+        {
+            this->addFollows(t1.last, t2.first);
+
+            auto first = t1.nullable ? GlushkovBuilder::unionPositions(t1.first, t2.first) : t1.first;
+            auto last = t2.nullable ? GlushkovBuilder::unionPositions(t1.last, t2.last) : t2.last;
+            return GlushkovTermInfo(t1.nullable && t2.nullable, first, last);
+        }
+
+        GlushkovTermInfo star(const GlushkovTermInfo& t)
+        {
+            this->addFollows(t.last, t.first);
+            return GlushkovTermInfo(true, t.first, t.last);
+        }
+
+        GlushkovTermInfo buildLiteral(const LiteralOpt* opt)
+        {
+            GlushkovTermInfo res;
+            for(size_t i = 0; i < opt->codes.size() && !this->overflow; ++i) {
+                const RegexChar c = this->isreverse ? opt->codes[opt->codes.size() - (i + 1)] : opt->codes[i];
+                const size_t p = this->addPosition(new NFAOptCharCode(0, c, 0));
+                res = this->concat(res, GlushkovTermInfo(false, { p }, { p }));
+            }
+
+            return res;
+        }
+
+        GlushkovTermInfo buildRangeRepeat(const RangeRepeatOpt* opt)
+        {
+            GlushkovTermInfo res;
+            for(size_t i = 0; i < opt->low && !this->overflow; ++i) {
+                res = this->concat(res, this->build(opt->repeat));
+            }
+
+            if(opt->high == UINT16_MAX) {
+                return this->overflow ? res : this->concat(res, this->star(this->build(opt->repeat)));
+            }
+
+            //the optional copies r{0,k} = (r (r ...)?)? -- built in reading order and then linked from the innermost
+            std::vector<GlushkovTermInfo> optcopies;
+            for(size_t i = opt->low; i < opt->high && !this->overflow; ++i) {
+                optcopies.push_back(this->build(opt->repeat));
+            }
+
+            if(this->overflow || optcopies.empty()) {
+                return res;
+            }
+
+            GlushkovTermInfo tail = optcopies.back();
+            tail.nullable = true;
+            for(int64_t i = (int64_t)optcopies.size() - 2; i >= 0; --i) {
+                tail = this->concat(optcopies[i], tail);
+                tail.nullable = true;
+            }
+
+            return this->concat(res, tail);
+        }
+
+    public:
+        const bool isreverse;
+        bool overflow;
+
+        //position 0 is the start position with a predicate that never matches
+        std::vector<NFAOpt*> positions;
+        std::vector<std::vector<size_t>> follows;
+
+        GlushkovBuilder(bool isreverse) : isreverse(isreverse), overflow(false), positions(), follows()
+        {
+            this->positions.push_back(new NFAOptRange(0, false, {}, 0));
+            this->follows.push_back({});
+        }
+
+        ~GlushkovBuilder()
+        {
+            for(auto iter = this->positions.begin(); iter != this->positions.end(); ++iter) {
+                delete *iter;
+            }
+        }
+
+        GlushkovTermInfo build(const RegexOpt* opt)
+        {
+            if(this->overflow) {
+                return GlushkovTermInfo();
+            }
+
+            switch(opt->tag)
+            {
+            case RegexOptTag::Literal: {
+                return this->buildLiteral(static_cast<const LiteralOpt*>(opt));
+            }
+            case RegexOptTag::CharRange: {
+                const CharRangeOpt* rngopt = static_cast<const CharRangeOpt*>(opt);
+                const size_t p = this->addPosition(new NFAOptRange(0, rngopt->compliment, rngopt->ranges, 0));
+                return GlushkovTermInfo(false, { p }, { p });
+            }
+            case RegexOptTag::CharClassDot: {
+                const size_t p = this->addPosition(new NFAOptDot(0, 0));
+                return GlushkovTermInfo(false, { p }, { p });
+            }
+            case RegexOptTag::StarRepeat: {
+                return this->star(this->build(static_cast<const StarRepeatOpt*>(opt)->repeat));
+            }
+            case RegexOptTag::PlusRepeat: {
+                auto t = this->build(static_cast<const PlusRepeatOpt*>(opt)->repeat);
+                this->addFollows(t.last, t.first);
+                return t;
+            }
+            case RegexOptTag::RangeRepeat: {
+                return this->buildRangeRepeat(static_cast<const RangeRepeatOpt*>(opt));
+            }
+            case RegexOptTag::Optional: {
+                auto t = this->build(static_cast<const OptionalOpt*>(opt)->opt);
+                t.nullable = true;
+                return t;
+            }
+            case RegexOptTag::AnyOf: {
+                const AnyOfOpt* anyopt = static_cast<const AnyOfOpt*>(opt);
+
+                GlushkovTermInfo res(false, {}, {});
+                for(auto iter = anyopt->opts.cbegin(); iter != anyopt->opts.cend(); ++iter) {
+                    auto t = this->build(*iter);
+                    res = GlushkovTermInfo(res.nullable || t.nullable, GlushkovBuilder::unionPositions(res.first, t.first), GlushkovBuilder::unionPositions(res.last, t.last));
+                }
+                return res;
+            }
+            case RegexOptTag::Sequence: {
+                const SequenceOpt* seqopt = static_cast<const SequenceOpt*>(opt);
+
+                GlushkovTermInfo res;
+                for(size_t i = 0; i < seqopt->regexs.size(); ++i) {
+                    const RegexOpt* ropt = this->isreverse ? seqopt->regexs[seqopt->regexs.size() - (i + 1)] : seqopt->regexs[i];
+                    res = this->concat(res, this->build(ropt));
+                }
+                return res;
+            }
+            default: {
+                //names and env regexes should be resolved before we get here
+                this->overflow = true;
+                return GlushkovTermInfo();
+            }
+            }
+        }
+    };
+
+    BitParallelMachine* BitParallelMachine::tryCompile(const RegexOpt* opt, bool isreverse, std::shared_ptr<const CharClassMap> classes)
+    {
+        GlushkovBuilder builder(isreverse);
+        auto root = builder.build(opt);
+        if(builder.overflow) {
+            return nullptr;
+        }
+
+        builder.follows[0] = root.first;
+
+        const size_t positioncount = builder.positions.size();
+        size_t wordcount = (positioncount + 63) / 64;
+        if(wordcount == 3) {
+            wordcount = 4;
+        }
+
+        BitParallelState shiftmask = {0};
+        BitParallelState exceptionmask = {0};
+        std::vector<uint32_t> exceptionindex(positioncount, 0);
+        std::vector<uint64_t> exceptionfollows;
+        for(size_t p = 0; p < positioncount; ++p) {
+            std::vector<size_t>& pfollows = builder.follows[p];
+            std::sort(pfollows.begin(), pfollows.end());
+            pfollows.erase(std::unique(pfollows.begin(), pfollows.end()), pfollows.end());
+
+            bool hasexception = false;
+            for(auto iter = pfollows.cbegin(); iter != pfollows.cend(); ++iter) {
+                if(*iter == p + 1) {
+                    shiftmask[*iter / 64] |= (uint64_t(1) << (*iter % 64));
+                }
+                else {
+                    hasexception = true;
+                }
+            }
+
+            if(hasexception) {
+                exceptionmask[p / 64] |= (uint64_t(1) << (p % 64));
+                exceptionindex[p] = (uint32_t)(exceptionfollows.size() / wordcount);
+
+                exceptionfollows.resize(exceptionfollows.size() + wordcount, 0);
+                uint64_t* efollows = exceptionfollows.data() + (exceptionindex[p] * wordcount);
+                for(auto iter = pfollows.cbegin(); iter != pfollows.cend(); ++iter) {
+                    if(*iter != p + 1) {
+                        efollows[*iter / 64] |= (uint64_t(1) << (*iter % 64));
+                    }
+                }
+            }
+        }
+
+        BitParallelState finalmask = {0};
+        for(auto iter = root.last.cbegin(); iter != root.last.cend(); ++iter) {
+            finalmask[*iter / 64] |= (uint64_t(1) << (*iter % 64));
+        }
+        if(root.nullable) {
+            finalmask[0] |= 1;
+        }
+
+        //the position predicates laid out as an NFA program (the follows are unused)
+        const NFAProgram predicates = NFAProgram::assemble(builder.positions);
+        if(!classes->separates(predicates)) {
+            classes = std::make_shared<const CharClassMap>(CharClassMap::build(predicates));
+        }
+
+        std::vector<uint64_t> classmasks(classes->classcount() * wordcount, 0);
+        for(size_t cls = 0; cls < classes->classcount(); ++cls) {
+            //the start position (0) is never entered
+            for(size_t p = 1; p < positioncount; ++p) {
+                if(predicates.charTest((StateID)p, classes->representative(cls))) {
+                    classmasks[(cls * wordcount) + (p / 64)] |= (uint64_t(1) << (p % 64));
+                }
+            }
+        }
+
+        //universal positions are final and match every class -- drop the ones without a universal follow until nothing changes
+        std::vector<bool> universal(positioncount, false);
+        for(size_t p = 1; p < positioncount; ++p) {
+            bool anychar = (finalmask[p / 64] & (uint64_t(1) << (p % 64))) != 0;
+            for(size_t cls = 0; cls < classes->classcount() && anychar; ++cls) {
+                anychar = (classmasks[(cls * wordcount) + (p / 64)] & (uint64_t(1) << (p % 64))) != 0;
+            }
+            universal[p] = anychar;
+        }
+
+        bool changed = true;
+        while(changed) {
+            changed = false;
+            for(size_t p = 1; p < positioncount; ++p) {
+                if(universal[p] && std::none_of(builder.follows[p].cbegin(), builder.follows[p].cend(), [&universal](size_t q) { return (bool)universal[q]; })) {
+                    universal[p] = false;
+                    changed = true;
+                }
+            }
+        }
+
+        BitParallelState universalmask = {0};
+        for(size_t p = 1; p < positioncount; ++p) {
+            if(universal[p]) {
+                universalmask[p / 64] |= (uint64_t(1) << (p % 64));
+            }
+        }
+
+        return new BitParallelMachine(wordcount, classes, classmasks, shiftmask, exceptionmask, exceptionindex, exceptionfollows, finalmask, universalmask);
+    }
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include "../common.h"
+
+#include <array>
+
+#include "nfa_machine.h"
+#include "charclass_map.h"
+
+namespace brex
+{
+    class RegexOpt;
+
+    //max number of positions (including the start position) in a bit-parallel machine and the number of words that takes
+    #define BITPARALLEL_MAX_POSITIONS 256
+    #define BITPARALLEL_MAX_WORDS (BITPARALLEL_MAX_POSITIONS / 64)
+
+    typedef std::array<uint64_t, BITPARALLEL_MAX_WORDS> BitParallelState;
+
+    //A Glushkov (position) automaton where the set of active positions is a bitset and each step is a shift plus a few exceptional follow sets, masked by the positions that accept the char
+    class BitParallelMachine
+    {
+    public:
+        //number of 64 bit words used for a state
+        const size_t wordcount;
+
+        //shared with the other machines of the regex (unless they do not separate the chars its positions test)
+        const std::shared_ptr<const CharClassMap> classes;
+
+        //wordcount entries per class with the positions that match a char in the class
+        const std::vector<uint64_t> classmasks;
+
+        //bit p + 1 is set if p + 1 follows p
+        const BitParallelState shiftmask;
+
+        //positions that have follows other than p + 1 and their follow sets (wordcount entries per exception)
+        const BitParallelState exceptionmask;
+        const std::vector<uint32_t> exceptionindex;
+        const std::vector<uint64_t> exceptionfollows;
+
+        //positions that are the last char of a match (and the start position if the regex accepts the empty string)
+        const BitParallelState finalmask;
+
+        //final positions that match any char and are followed by another of these positions -- once one is active every extension of the input is accepted
+        const BitParallelState universalmask;
+        const bool hasuniversal;
+
+        BitParallelMachine(size_t wordcount, std::shared_ptr<const CharClassMap> classes, std::vector<uint64_t> classmasks, BitParallelState shiftmask, BitParallelState exceptionmask, std::vector<uint32_t> exceptionindex, std::vector<uint64_t> exceptionfollows, BitParallelState finalmask, BitParallelState universalmask) : wordcount(wordcount), classes(classes), classmasks(classmasks), shiftmask(shiftmask), exceptionmask(exceptionmask), exceptionindex(exceptionindex), exceptionfollows(exceptionfollows), finalmask(finalmask), universalmask(universalmask), hasuniversal(std::any_of(universalmask.cbegin(), universalmask.cend(), [](uint64_t w) { return w != 0; })) {;}
+        ~BitParallelMachine() = default;
+
+        //build the machine for the (resolved) regex read forward or in reverse over the char classes of the regex -- nullptr if it needs more than BITPARALLEL_MAX_POSITIONS positions
+        static BitParallelMachine* tryCompile(const RegexOpt* opt, bool isreverse, std::shared_ptr<const CharClassMap> classes);
+
+        template <size_t W>
+        inline void intitializeMachine(BitParallelState& s) const
+        {
+            s.fill(0);
+            s[0] = 1;
+        }
+
+        //kept out of line -- when inlined the wide state handling bloats the executor dispatch that is shared with the (much more common) DFA engines
+        template <size_t W>
+        __attribute__((noinline)) void stepMachine(BitParallelState& s, RegexChar c) const
+        {
+            uint64_t ns[W];
+            for(size_t i = 0; i < W; ++i) {
+                const uint64_t carry = (i != 0) ? (s[i - 1] >> 63) : 0;
+                ns[i] = ((s[i] << 1) | carry) & this->shiftmask[i];
+            }
+
+            for(size_t i = 0; i < W; ++i) {
+                uint64_t exceptions = s[i] & this->exceptionmask[i];
+                while(exceptions != 0) {
+                    const size_t p = (i * 64) + (size_t)__builtin_ctzll(exceptions);
+                    exceptions &= (exceptions - 1);
+
+                    const uint64_t* follows = this->exceptionfollows.data() + (this->exceptionindex[p] * W);
+                    for(size_t j = 0; j < W; ++j) {
+                        ns[j] |= follows[j];
+                    }
+                }
+            }
+
+            const uint64_t* cmask = this->classmasks.data() + (this->classes->classOf(c) * W);
+            for(size_t i = 0; i < W; ++i) {
+                s[i] = ns[i] & cmask[i];
+            }
+        }
+
+        template <size_t W>
+        inline bool inAccepted(const BitParallelState& s) const
+        {
+            uint64_t acc = 0;
+            for(size_t i = 0; i < W; ++i) {
+                acc |= (s[i] & this->finalmask[i]);
+            }
+
+            return acc != 0;
+        }
+
+        template <size_t W>
+        inline bool allRejected(const BitParallelState& s) const
+        {
+            uint64_t acc = 0;
+            for(size_t i = 0; i < W; ++i) {
+                acc |= s[i];
+            }
+
+            return acc == 0;
+        }
+
+        template <size_t W>
+        inline bool allAccepted(const BitParallelState& s) const
+        {
+            uint64_t acc = 0;
+            for(size_t i = 0; i < W; ++i) {
+                acc |= (s[i] & this->universalmask[i]);
+            }
+
+            return acc != 0;
+        }
+    };
+}
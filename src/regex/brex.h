@@ -332,7 +332,7 @@ namespace brex
     public:
         const RegexOpt* repeat;
         const uint16_t low;
-        const uint16_t high; //if high == INT16_MAX then this is an unbounded repeat
+        const uint16_t high; //if high == UINT16_MAX then this is an unbounded repeat
 
         RangeRepeatOpt(uint16_t low, uint16_t high, const RegexOpt* repeat) : RegexOpt(RegexOptTag::RangeRepeat), repeat(repeat), low(low), high(high) {;}
         virtual ~RangeRepeatOpt() = default;
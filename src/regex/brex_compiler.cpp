@@ -1,4 +1,5 @@
 #include "brex_compiler.h"
+#include "nfa_optimizer.h"
 
 namespace brex
 {
@@ -64,16 +65,14 @@ namespace brex
 
     const RegexOpt* RegexResolver::resolveRangeRepeatOpt(const RangeRepeatOpt* opt)
     {
-        if(this->inRangeRepeat) {
-            this->errors.push_back(RegexCompileError(u8"Range repeats cannot be nested"));
+        if(this->rangeRepeatDepth == NFA_MAX_RANGE_NESTING) {
+            const std::string maxdepth = std::to_string(NFA_MAX_RANGE_NESTING);
+            this->errors.push_back(RegexCompileError(u8"Range repeats cannot be nested more than " + std::u8string(maxdepth.cbegin(), maxdepth.cend()) + u8" deep"));
         }
 
-        auto oinRepeat = this->inRangeRepeat;
-        this->inRangeRepeat = true;
-
+        this->rangeRepeatDepth++;
         auto resolvedRepeat = this->resolve(opt->repeat);
-
-        this->inRangeRepeat = oinRepeat;
+        this->rangeRepeatDepth--;
         return new RangeRepeatOpt(opt->low, opt->high, resolvedRepeat);
     }
 
@@ -442,4 +441,17 @@ namespace brex
         }
         }
     }
+
+    NFAMachine* RegexCompiler::assembleMachine(StateID startstate, std::vector<NFAOpt*>& states)
+    {
+        startstate = NFAOptimizer::optimize(startstate, states);
+
+        NFAProgram program = NFAProgram::assemble(states);
+        for(auto iter = states.begin(); iter != states.end(); ++iter) {
+            delete *iter;
+        }
+        states.clear();
+
+        return new NFAMachine(startstate, 0, std::move(program));
+    }
 }
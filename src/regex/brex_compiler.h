@@ -46,9 +46,9 @@ namespace brex
         std::vector<RegexCompileError> errors;
         std::vector<std::string> pending_resolves;
 
-        bool inRangeRepeat;
+        size_t rangeRepeatDepth;
 
-        RegexResolver(NameResolverState resolverState, fnNameResolver nameResolverFn, const std::map<std::string, const RegexOpt*>& namedRegexes, bool envEnabled, const std::map<std::string, const LiteralOpt*>& envRegexes) : resolverState(resolverState), nameResolverFn(nameResolverFn), namedRegexes(namedRegexes), envEnabled(envEnabled), envRegexes(envRegexes), errors(), pending_resolves(), inRangeRepeat(false) { ; }
+        RegexResolver(NameResolverState resolverState, fnNameResolver nameResolverFn, const std::map<std::string, const RegexOpt*>& namedRegexes, bool envEnabled, const std::map<std::string, const LiteralOpt*>& envRegexes) : resolverState(resolverState), nameResolverFn(nameResolverFn), namedRegexes(namedRegexes), envEnabled(envEnabled), envRegexes(envRegexes), errors(), pending_resolves(), rangeRepeatDepth(0) { ; }
         ~RegexResolver() = default;
 
         const RegexOpt* resolve(const RegexOpt* opt);
@@ -83,10 +83,18 @@ namespace brex
 
         static StateID reverseCompileOpt(StateID follows, std::vector<NFAOpt*>& states, const RegexOpt* opt);
 
+        //lay out the compiled states as a flat program for the machine and free them
+        static NFAMachine* assembleMachine(StateID startstate, std::vector<NFAOpt*>& states);
+
         std::vector<RegexCompileError> errors;
 
+        //max number of states for ahead of time DFA compilation of each machine (0 to only use the NFA/lazy DFA)
+        const size_t dfaStateBudget;
+
+        //searchable is false for checks that are never used in unanchored searches (AllOf members and the anchored composite) so they do not get search machines
+        //anchors are searchable so a search pass marks every boundary they accept (a negated anchor gets the search machines of its positive regex)
         template <typename TStr, typename TIter>
-        std::optional<SingleCheckREInfo<TStr, TIter>*> compileSingleTopLevelEntry(const RegexToplevelEntry& tlre, const std::map<std::string, const RegexOpt*>& namedRegexes, const std::map<std::string, const LiteralOpt*>& envRegexes, bool envEnabled, NameResolverState resolverState, fnNameResolver nameResolverFn)
+        std::optional<SingleCheckREInfo<TStr, TIter>*> compileSingleTopLevelEntry(const RegexToplevelEntry& tlre, bool searchable, const std::map<std::string, const RegexOpt*>& namedRegexes, const std::map<std::string, const LiteralOpt*>& envRegexes, bool envEnabled, NameResolverState resolverState, fnNameResolver nameResolverFn)
         {
             RegexResolver resolver(resolverState, nameResolverFn, namedRegexes, envEnabled, envRegexes);
             auto fullre = resolver.resolve(tlre.opt);
@@ -97,13 +105,74 @@ namespace brex
 
             std::vector<NFAOpt*> nfastates_forward = { new NFAOptAccept(0) };
             auto nfastart_forward = RegexCompiler::compileOpt(0, nfastates_forward, fullre);
-            NFAMachine* nfaforward = new NFAMachine(nfastart_forward, 0, nfastates_forward);
+            NFAMachine* nfaforward = RegexCompiler::assembleMachine(nfastart_forward, nfastates_forward);
 
             std::vector<NFAOpt*> nfastates_reverse = { new NFAOptAccept(0) };
             auto nfastart_reverse = RegexCompiler::reverseCompileOpt(0, nfastates_reverse, fullre);
-            NFAMachine* nfareverse = new NFAMachine(nfastart_reverse, 0, nfastates_reverse);
+            NFAMachine* nfareverse = RegexCompiler::assembleMachine(nfastart_reverse, nfastates_reverse);
             
-            NFAExecutor<TStr, TIter> nn(nfaforward, nfareverse);
+            //front/back checks are never used in unanchored searches -- the search machines run the regex behind a leading .* (in the direction of the search)
+            NFAMachine* nfaforwardsearch = nullptr;
+            NFAMachine* nfareversesearch = nullptr;
+            const SequenceOpt* forwardsearchre = nullptr;
+            const SequenceOpt* reversesearchre = nullptr;
+            const StarRepeatOpt* anystar = nullptr;
+            const CharClassDotOpt* anychar = nullptr;
+            const bool hassearch = searchable && !tlre.isFrontCheck && !tlre.isBackCheck;
+            if(hassearch) {
+                anychar = new CharClassDotOpt();
+                anystar = new StarRepeatOpt(anychar);
+                forwardsearchre = new SequenceOpt({ anystar, fullre });
+                reversesearchre = new SequenceOpt({ fullre, anystar });
+
+                std::vector<NFAOpt*> nfastates_forwardsearch = { new NFAOptAccept(0) };
+                auto nfastart_forwardsearch = RegexCompiler::compileOpt(0, nfastates_forwardsearch, forwardsearchre);
+                nfaforwardsearch = RegexCompiler::assembleMachine(nfastart_forwardsearch, nfastates_forwardsearch);
+
+                std::vector<NFAOpt*> nfastates_reversesearch = { new NFAOptAccept(0) };
+                auto nfastart_reversesearch = RegexCompiler::reverseCompileOpt(0, nfastates_reversesearch, reversesearchre);
+                nfareversesearch = RegexCompiler::assembleMachine(nfastart_reversesearch, nfastates_reversesearch);
+            }
+
+            //one set of char classes (split by the tests of every machine) is shared by all of the DFA, bit-parallel, and lazy DFA machines of the regex
+            std::vector<const NFAProgram*> programs = { &nfaforward->program, &nfareverse->program };
+            if(hassearch) {
+                programs.push_back(&nfaforwardsearch->program);
+                programs.push_back(&nfareversesearch->program);
+            }
+            auto classes = std::make_shared<const CharClassMap>(CharClassMap::build(programs));
+
+            DFAMachine* dfaforward = DFAMachine::tryCompile(nfaforward, classes, this->dfaStateBudget);
+            DFAMachine* dfareverse = DFAMachine::tryCompile(nfareverse, classes, this->dfaStateBudget);
+
+            //bit-parallel machines are only needed when there is no AOT DFA
+            BitParallelMachine* bpforward = (dfaforward == nullptr) ? BitParallelMachine::tryCompile(fullre, false, classes) : nullptr;
+            BitParallelMachine* bpreverse = (dfareverse == nullptr) ? BitParallelMachine::tryCompile(fullre, true, classes) : nullptr;
+
+            DFAMachine* dfaforwardsearch = nullptr;
+            DFAMachine* dfareversesearch = nullptr;
+            BitParallelMachine* bpforwardsearch = nullptr;
+            BitParallelMachine* bpreversesearch = nullptr;
+            LiteralPrefilter<TStr> prefilter;
+            FirstCharScanner scanner;
+            if(hassearch) {
+                dfaforwardsearch = DFAMachine::tryCompile(nfaforwardsearch, classes, this->dfaStateBudget);
+                dfareversesearch = DFAMachine::tryCompile(nfareversesearch, classes, this->dfaStateBudget);
+
+                bpforwardsearch = (dfaforwardsearch == nullptr) ? BitParallelMachine::tryCompile(forwardsearchre, false, classes) : nullptr;
+                bpreversesearch = (dfareversesearch == nullptr) ? BitParallelMachine::tryCompile(reversesearchre, true, classes) : nullptr;
+
+                prefilter = LiteralPrefilter<TStr>::build(fullre);
+                scanner = FirstCharScanner::build(nfaforward, std::is_same_v<TStr, UnicodeString>);
+
+                //the wrappers are only needed to compile the search machines -- fullre is not owned here so it is not freed with them
+                delete forwardsearchre;
+                delete reversesearchre;
+                delete anystar;
+                delete anychar;
+            }
+
+            NFAExecutor<TStr, TIter> nn(nfaforward, nfareverse, nfaforwardsearch, nfareversesearch, dfaforward, dfareverse, dfaforwardsearch, dfareversesearch, bpforward, bpreverse, bpforwardsearch, bpreversesearch, prefilter, scanner, classes);
 
             auto bsqstd = fullre->toBSQStandard();
             auto smtre = fullre->toSMTRegex();
@@ -113,11 +182,11 @@ namespace brex
         }
         
         template <typename TStr, typename TIter>
-        ComponentCheckREInfo<TStr, TIter>* compileComponent(const RegexComponent* cc, const std::map<std::string, const RegexOpt*>& namedRegexes, const std::map<std::string, const LiteralOpt*>& envRegexes, bool envEnabled, NameResolverState resolverState, fnNameResolver nameResolverFn)
+        ComponentCheckREInfo<TStr, TIter>* compileComponent(const RegexComponent* cc, bool searchable, const std::map<std::string, const RegexOpt*>& namedRegexes, const std::map<std::string, const LiteralOpt*>& envRegexes, bool envEnabled, NameResolverState resolverState, fnNameResolver nameResolverFn)
         {
             if(cc->tag == RegexComponentTag::Single) {
                 auto sc = static_cast<const RegexSingleComponent*>(cc);
-                auto cv = this->compileSingleTopLevelEntry<TStr, TIter>(sc->entry, namedRegexes, envRegexes, envEnabled, resolverState, nameResolverFn);
+                auto cv = this->compileSingleTopLevelEntry<TStr, TIter>(sc->entry, searchable, namedRegexes, envRegexes, envEnabled, resolverState, nameResolverFn);
 
                 if(cv.has_value()) {
                     return cv.value();
@@ -130,18 +199,83 @@ namespace brex
                 auto allc = static_cast<const RegexAllOfComponent*>(cc);
 
                 std::vector<SingleCheckREInfo<TStr, TIter>*> checks;
+                std::vector<const NFAMachine*> productforward;
+                std::vector<const NFAMachine*> productreverse;
+                std::vector<bool> complemented;
                 for(auto ii = allc->musts.cbegin(); ii != allc->musts.cend(); ++ii) {
-                    auto cv = this->compileSingleTopLevelEntry<TStr, TIter>(*ii, namedRegexes, envRegexes, envEnabled, resolverState, nameResolverFn);
+                    auto cv = this->compileSingleTopLevelEntry<TStr, TIter>(*ii, false, namedRegexes, envRegexes, envEnabled, resolverState, nameResolverFn);
                     if(cv.has_value()) {
                         checks.push_back(cv.value());
+                        if(!ii->isFrontCheck && !ii->isBackCheck) {
+                            productforward.push_back(cv.value()->executor.forwardMachine());
+                            productreverse.push_back(cv.value()->executor.reverseMachine());
+                            complemented.push_back(ii->isNegated);
+                        }
                     }
                     else {
                         return nullptr;
                     }
                 }
 
-                return new MultiCheckREInfo<TStr, TIter>(checks);
+                //the binding checks and the complements of the negated checks are run together as a product DFA (when it fits in the state budget) instead of one pass each
+                std::optional<DFAProductExecutor<TStr, TIter>> product = std::nullopt;
+                if(productforward.size() > 1) {
+                    std::vector<const NFAProgram*> programs;
+                    std::transform(productforward.cbegin(), productforward.cend(), std::back_inserter(programs), [](const NFAMachine* m) { return &m->program; });
+                    std::transform(productreverse.cbegin(), productreverse.cend(), std::back_inserter(programs), [](const NFAMachine* m) { return &m->program; });
+                    auto classes = std::make_shared<const CharClassMap>(CharClassMap::build(programs));
+
+                    DFAMachine* dfaforward = DFAMachine::tryCompileProduct(productforward, complemented, classes, this->dfaStateBudget);
+                    DFAMachine* dfareverse = (dfaforward != nullptr) ? DFAMachine::tryCompileProduct(productreverse, complemented, classes, this->dfaStateBudget) : nullptr;
+                    if(dfaforward != nullptr && dfareverse != nullptr) {
+                        product = std::make_optional(DFAProductExecutor<TStr, TIter>(dfaforward, dfareverse));
+                    }
+                }
+
+                return new MultiCheckREInfo<TStr, TIter>(checks, product);
+            }
+        }
+
+        static bool isPlainSingleComponent(const RegexComponent* cc)
+        {
+            if(cc->tag != RegexComponentTag::Single) {
+                return false;
             }
+
+            const RegexToplevelEntry& entry = static_cast<const RegexSingleComponent*>(cc)->entry;
+            return !entry.isNegated && !entry.isFrontCheck && !entry.isBackCheck;
+        }
+
+        //the concatenation pre re post as one plain check so anchored ops run in a single pass instead of checking the anchors at each span of re
+        //only when every part is a plain single check and re does not accept the empty string (the spans of re are never empty)
+        template <typename TStr, typename TIter>
+        SingleCheckREInfo<TStr, TIter>* compileAnchoredComposite(const Regex* re, ComponentCheckREInfo<TStr, TIter>* cre, const std::map<std::string, const RegexOpt*>& namedRegexes, const std::map<std::string, const LiteralOpt*>& envRegexes, bool envEnabled, NameResolverState resolverState, fnNameResolver nameResolverFn)
+        {
+            if(re->preanchor == nullptr && re->postanchor == nullptr) {
+                return nullptr;
+            }
+
+            if(!RegexCompiler::isPlainSingleComponent(re->re) || (re->preanchor != nullptr && !RegexCompiler::isPlainSingleComponent(re->preanchor)) || (re->postanchor != nullptr && !RegexCompiler::isPlainSingleComponent(re->postanchor))) {
+                return nullptr;
+            }
+
+            if(static_cast<SingleCheckREInfo<TStr, TIter>*>(cre)->executor.forwardMachine()->acceptsEmpty()) {
+                return nullptr;
+            }
+
+            std::vector<const RegexOpt*> parts;
+            for(auto cc : { re->preanchor, re->re, re->postanchor }) {
+                if(cc != nullptr) {
+                    parts.push_back(static_cast<const RegexSingleComponent*>(cc)->entry.opt);
+                }
+            }
+
+            //the wrapper does not own the parts so deleting it leaves them alone
+            const SequenceOpt* composite = new SequenceOpt(parts);
+            auto cv = this->compileSingleTopLevelEntry<TStr, TIter>(RegexToplevelEntry(false, false, false, composite), false, namedRegexes, envRegexes, envEnabled, resolverState, nameResolverFn);
+            delete composite;
+
+            return cv.has_value() ? cv.value() : nullptr;
         }
 
         static void gatherNamedRegexComponentKeys(std::set<std::string>& constnames, std::set<std::string>& envnames, const RegexComponent* cc)
@@ -159,24 +293,26 @@ namespace brex
         }
 
     public:
-        RegexCompiler() : errors() { ; }
+        RegexCompiler(size_t dfaStateBudget) : errors(), dfaStateBudget(dfaStateBudget) { ; }
         ~RegexCompiler() = default;
 
         template <typename TStr, typename TIter, bool isunicode>
-        static REExecutor<TStr, TIter, isunicode>* compileRegexToExecutor(const Regex* re, const std::map<std::string, const RegexOpt*>& namedRegexes, const std::map<std::string, const LiteralOpt*>& envRegexes, bool envEnabled, NameResolverState resolverState, fnNameResolver nameResolverFn, std::vector<RegexCompileError>& errinfo)
+        static REExecutor<TStr, TIter, isunicode>* compileRegexToExecutor(const Regex* re, const std::map<std::string, const RegexOpt*>& namedRegexes, const std::map<std::string, const LiteralOpt*>& envRegexes, bool envEnabled, NameResolverState resolverState, fnNameResolver nameResolverFn, std::vector<RegexCompileError>& errinfo, size_t dfaStateBudget = DFA_DEFAULT_STATE_BUDGET)
         {
-            RegexCompiler rcc;
+            RegexCompiler rcc(dfaStateBudget);
 
-            ComponentCheckREInfo<TStr, TIter>* optPre = re->preanchor != nullptr ? rcc.compileComponent<TStr, TIter>(re->preanchor, namedRegexes, envRegexes, envEnabled, resolverState, nameResolverFn) : nullptr; 
-            ComponentCheckREInfo<TStr, TIter>* optPost = re->postanchor != nullptr ? rcc.compileComponent<TStr, TIter>(re->postanchor, namedRegexes, envRegexes, envEnabled, resolverState, nameResolverFn) : nullptr;
-            ComponentCheckREInfo<TStr, TIter>* cre = rcc.compileComponent<TStr, TIter>(re->re, namedRegexes, envRegexes, envEnabled, resolverState, nameResolverFn);
+            ComponentCheckREInfo<TStr, TIter>* optPre = re->preanchor != nullptr ? rcc.compileComponent<TStr, TIter>(re->preanchor, true, namedRegexes, envRegexes, envEnabled, resolverState, nameResolverFn) : nullptr; 
+            ComponentCheckREInfo<TStr, TIter>* optPost = re->postanchor != nullptr ? rcc.compileComponent<TStr, TIter>(re->postanchor, true, namedRegexes, envRegexes, envEnabled, resolverState, nameResolverFn) : nullptr;
+            ComponentCheckREInfo<TStr, TIter>* cre = rcc.compileComponent<TStr, TIter>(re->re, true, namedRegexes, envRegexes, envEnabled, resolverState, nameResolverFn);
 
             if(!rcc.errors.empty()) {
                 std::copy(rcc.errors.cbegin(), rcc.errors.cend(), std::back_inserter(errinfo));
                 return nullptr;
             }
 
-            return new REExecutor<TStr, TIter, isunicode>(re, optPre, optPost, cre);
+            SingleCheckREInfo<TStr, TIter>* anchored = rcc.compileAnchoredComposite<TStr, TIter>(re, cre, namedRegexes, envRegexes, envEnabled, resolverState, nameResolverFn);
+
+            return new REExecutor<TStr, TIter, isunicode>(re, optPre, optPost, cre, anchored);
         }
 
         static bool gatherNamedRegexKeys(std::set<std::string>& constnames, std::set<std::string>& envnames, const Regex* re)
@@ -194,7 +330,7 @@ namespace brex
             return !envnames.empty();
         }
 
-        static UnicodeRegexExecutor* compileUnicodeRegexToExecutor(const Regex* re, const std::map<std::string, const RegexOpt*>& namedRegexes, const std::map<std::string, const LiteralOpt*>& envRegexes, bool envEnabled, NameResolverState resolverState, fnNameResolver nameResolverFn, std::vector<RegexCompileError>& errinfo)
+        static UnicodeRegexExecutor* compileUnicodeRegexToExecutor(const Regex* re, const std::map<std::string, const RegexOpt*>& namedRegexes, const std::map<std::string, const LiteralOpt*>& envRegexes, bool envEnabled, NameResolverState resolverState, fnNameResolver nameResolverFn, std::vector<RegexCompileError>& errinfo, size_t dfaStateBudget = DFA_DEFAULT_STATE_BUDGET)
         {
             if(re->ctag != RegexCharInfoTag::Unicode) {
                 errinfo.push_back(RegexCompileError(u8"Expected a Unicode regex"));
@@ -206,10 +342,10 @@ namespace brex
                 return nullptr;
             }
 
-            return compileRegexToExecutor<UnicodeString, UnicodeRegexIterator, true>(re, namedRegexes, envRegexes, envEnabled, resolverState, nameResolverFn, errinfo);
+            return compileRegexToExecutor<UnicodeString, UnicodeRegexIterator, true>(re, namedRegexes, envRegexes, envEnabled, resolverState, nameResolverFn, errinfo, dfaStateBudget);
         }
 
-        static CRegexExecutor* compileCRegexToExecutor(const Regex* re, const std::map<std::string, const RegexOpt*>& namedRegexes, const std::map<std::string, const LiteralOpt*>& envRegexes, bool envEnabled, NameResolverState resolverState, fnNameResolver nameResolverFn, std::vector<RegexCompileError>& errinfo)
+        static CRegexExecutor* compileCRegexToExecutor(const Regex* re, const std::map<std::string, const RegexOpt*>& namedRegexes, const std::map<std::string, const LiteralOpt*>& envRegexes, bool envEnabled, NameResolverState resolverState, fnNameResolver nameResolverFn, std::vector<RegexCompileError>& errinfo, size_t dfaStateBudget = DFA_DEFAULT_STATE_BUDGET)
         {
             if(re->ctag != RegexCharInfoTag::Char) {
                 errinfo.push_back(RegexCompileError(u8"Expected an char regex"));
@@ -221,10 +357,10 @@ namespace brex
                 return nullptr;
             }
 
-            return compileRegexToExecutor<CString, CRegexIterator, false>(re, namedRegexes, envRegexes, envEnabled, resolverState, nameResolverFn, errinfo);
+            return compileRegexToExecutor<CString, CRegexIterator, false>(re, namedRegexes, envRegexes, envEnabled, resolverState, nameResolverFn, errinfo, dfaStateBudget);
         }
 
-        static CRegexExecutor* compilePathRegexToExecutor(const Regex* re, const std::map<std::string, const RegexOpt*>& namedRegexes, const std::map<std::string, const LiteralOpt*>& envRegexes, bool envEnabled, NameResolverState resolverState, fnNameResolver nameResolverFn, std::vector<RegexCompileError>& errinfo)
+        static CRegexExecutor* compilePathRegexToExecutor(const Regex* re, const std::map<std::string, const RegexOpt*>& namedRegexes, const std::map<std::string, const LiteralOpt*>& envRegexes, bool envEnabled, NameResolverState resolverState, fnNameResolver nameResolverFn, std::vector<RegexCompileError>& errinfo, size_t dfaStateBudget = DFA_DEFAULT_STATE_BUDGET)
         {
             if(re->ctag != RegexCharInfoTag::Char) {
                 errinfo.push_back(RegexCompileError(u8"Expected an char regex"));
@@ -236,7 +372,7 @@ namespace brex
                 return nullptr;
             }
 
-            return compileRegexToExecutor<CString, CRegexIterator, false>(re, namedRegexes, envRegexes, envEnabled, resolverState, nameResolverFn, errinfo);
+            return compileRegexToExecutor<CString, CRegexIterator, false>(re, namedRegexes, envRegexes, envEnabled, resolverState, nameResolverFn, errinfo, dfaStateBudget);
         }
     };
 }
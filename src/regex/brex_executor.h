@@ -1,6 +1,9 @@
 #pragma once
 
 #include "../common.h"
+
+#include <iterator>
+
 #include "nfa_executor.h"
 
 namespace brex
@@ -34,12 +37,59 @@ namespace brex
 
         //return the first and last index of the substring that the regex accepts -- spos it the first matching index and epos is the longest matching index (empty if no match exists)
         virtual std::vector<std::pair<int64_t, int64_t>> matchContains(TStr* sstr, int64_t spos, int64_t epos) = 0;
+
+        //return the leftmost (and then longest) substring that the regex accepts -- and that starts and ends at boundaries that bounds allows (empty if no match exists)
+        virtual std::optional<std::pair<int64_t, int64_t>> matchContainsFirst(TStr* sstr, int64_t spos, int64_t epos, const SpanBounds& bounds) = 0;
+
+        //return the rightmost (and then longest) substring that the regex accepts -- and that starts and ends at boundaries that bounds allows (empty if no match exists)
+        virtual std::optional<std::pair<int64_t, int64_t>> matchContainsLast(TStr* sstr, int64_t spos, int64_t epos, const SpanBounds& bounds) = 0;
         
         //return the end index of the match -- starting from spos (or empty if no match is exists)
         virtual std::vector<int64_t> matchFront(TStr* sstr, int64_t spos, int64_t epos) = 0;
 
         //return the start index of the match -- ending at epos (or empty if no match is exists)
         virtual std::vector<int64_t> matchBack(TStr* sstr, int64_t spos, int64_t epos) = 0;
+
+        //the same as matchFront/matchBack but write into a caller owned buffer (cleared first) so a reused buffer does not allocate
+        virtual void matchFrontInto(TStr* sstr, int64_t spos, int64_t epos, std::vector<int64_t>& matches) = 0;
+        virtual void matchBackInto(TStr* sstr, int64_t spos, int64_t epos, std::vector<int64_t>& matches) = 0;
+
+        //return only the last entry of matchFront/matchBack (the longest match) without materializing the others
+        virtual std::optional<int64_t> matchFrontLongest(TStr* sstr, int64_t spos, int64_t epos) = 0;
+        virtual std::optional<int64_t> matchBackLongest(TStr* sstr, int64_t spos, int64_t epos) = 0;
+
+        //mark (at b - spos) each boundary b in [spos, epos + 1] where testBack(sstr, spos, b - 1) holds -- so an anchor is checked at every boundary of a search at once
+        virtual void testBackEachInto(TStr* sstr, int64_t spos, int64_t epos, std::vector<bool>& marks) = 0;
+
+        //mark (at b - spos) each boundary b in [spos, epos + 1] where testFront(sstr, b, epos) holds
+        virtual void testFrontEachInto(TStr* sstr, int64_t spos, int64_t epos, std::vector<bool>& marks) = 0;
+
+        //a copy that shares the compiled machines but has its own match state (so each thread can match with its own copy) -- the caller owns the result
+        virtual ComponentCheckREInfo* createMatchContext() const = 0;
+
+    protected:
+        //one test per char boundary for checks that have no search machines to mark them all in a single pass
+        void testBackEachBoundary(TStr* sstr, int64_t spos, int64_t epos, std::vector<bool>& marks)
+        {
+            marks.assign((size_t)(epos - spos + 2), false);
+            for(TIter biter{sstr, spos, epos, spos}; ; biter.inc()) {
+                marks[biter.curr - spos] = this->testBack(sstr, spos, biter.curr - 1);
+                if(!biter.valid()) {
+                    break;
+                }
+            }
+        }
+
+        void testFrontEachBoundary(TStr* sstr, int64_t spos, int64_t epos, std::vector<bool>& marks)
+        {
+            marks.assign((size_t)(epos - spos + 2), false);
+            for(TIter biter{sstr, spos, epos, spos}; ; biter.inc()) {
+                marks[biter.curr - spos] = this->testFront(sstr, biter.curr, epos);
+                if(!biter.valid()) {
+                    break;
+                }
+            }
+        }
     };
 
     template <typename TStr, typename TIter>
@@ -108,14 +158,8 @@ namespace brex
 
         bool testContains(TStr* sstr, int64_t spos, int64_t epos) override final
         {
-            //by def a single option that is not negative or front/back marked
-            for(int64_t ii = spos; ii <= epos; ++ii) {
-                if(this->executor.matchTestForward(sstr, ii, epos)) {
-                    return true;
-                }
-            }
-
-            return false;
+            //by def a single option that is not negative or front/back marked (so the executor has a search machine)
+            return this->executor.searchTest(sstr, spos, epos);
         }
 
         bool testFront(TStr* sstr, int64_t spos, int64_t epos) override final
@@ -132,19 +176,21 @@ namespace brex
 
         std::vector<std::pair<int64_t, int64_t>> matchContains(TStr* sstr, int64_t spos, int64_t epos) override final
         {
+            //by def a single option that is not negative or front/back marked (so the executor has search machines)
             std::vector<std::pair<int64_t, int64_t>> matches;
+            this->executor.matchSpans(sstr, spos, epos, matches);
 
-            for(int64_t ii = spos; ii <= epos; ++ii) {
-                auto mm = this->executor.matchForward(sstr, ii, epos);
+            return matches;
+        }
 
-                if(!mm.empty()) {
-                    std::transform(mm.cbegin(), mm.cend(), std::back_inserter(matches), [ii](int64_t epos) {
-                        return std::make_pair(ii, epos);
-                    });
-                }
-            }
+        std::optional<std::pair<int64_t, int64_t>> matchContainsFirst(TStr* sstr, int64_t spos, int64_t epos, const SpanBounds& bounds) override final
+        {
+            return this->executor.matchFirstSpan(sstr, spos, epos, bounds);
+        }
 
-            return matches;
+        std::optional<std::pair<int64_t, int64_t>> matchContainsLast(TStr* sstr, int64_t spos, int64_t epos, const SpanBounds& bounds) override final
+        {
+            return this->executor.matchLastSpan(sstr, spos, epos, bounds);
         }
 
         std::vector<int64_t> matchFront(TStr* sstr, int64_t spos, int64_t epos) override final
@@ -156,6 +202,58 @@ namespace brex
         {
             return this->executor.matchReverse(sstr, spos, epos);
         }
+
+        void matchFrontInto(TStr* sstr, int64_t spos, int64_t epos, std::vector<int64_t>& matches) override final
+        {
+            this->executor.matchForwardInto(sstr, spos, epos, matches);
+        }
+
+        void matchBackInto(TStr* sstr, int64_t spos, int64_t epos, std::vector<int64_t>& matches) override final
+        {
+            this->executor.matchReverseInto(sstr, spos, epos, matches);
+        }
+
+        std::optional<int64_t> matchFrontLongest(TStr* sstr, int64_t spos, int64_t epos) override final
+        {
+            return this->executor.matchForwardLongest(sstr, spos, epos);
+        }
+
+        std::optional<int64_t> matchBackLongest(TStr* sstr, int64_t spos, int64_t epos) override final
+        {
+            return this->executor.matchReverseLongest(sstr, spos, epos);
+        }
+
+        //testBack/testFront ignore the front/back marks so the search machines of the (positive) regex mark every boundary in one pass
+        void testBackEachInto(TStr* sstr, int64_t spos, int64_t epos, std::vector<bool>& marks) override final
+        {
+            if(!this->executor.canSearch()) {
+                this->testBackEachBoundary(sstr, spos, epos, marks);
+                return;
+            }
+
+            this->executor.markMatchEnds(sstr, spos, epos, marks);
+            if(this->isNegative) {
+                marks.flip();
+            }
+        }
+
+        void testFrontEachInto(TStr* sstr, int64_t spos, int64_t epos, std::vector<bool>& marks) override final
+        {
+            if(!this->executor.canSearch()) {
+                this->testFrontEachBoundary(sstr, spos, epos, marks);
+                return;
+            }
+
+            this->executor.markMatchStarts(sstr, spos, epos, marks);
+            if(this->isNegative) {
+                marks.flip();
+            }
+        }
+
+        SingleCheckREInfo* createMatchContext() const override final
+        {
+            return new SingleCheckREInfo(this->executor.createMatchContext(), this->isNegative, this->isFrontCheck, this->isBackCheck, this->bsqnf, this->smtre);
+        }
     };
 
     template <typename TStr, typename TIter>
@@ -164,8 +262,24 @@ namespace brex
     public:
         std::vector<SingleCheckREInfo<TStr, TIter>*> checks;
 
-        MultiCheckREInfo(const std::vector<SingleCheckREInfo<TStr, TIter>*>& checks) : ComponentCheckREInfo<TStr, TIter>(), checks(checks) {;}
-        virtual ~MultiCheckREInfo() = default;
+        //the product of the binding checks and the (complemented) plain negated checks so they run in a single pass (empty if there is only one or the product could not be compiled)
+        std::optional<DFAProductExecutor<TStr, TIter>> product;
+
+        //true for a match context (which made its own copies of the checks)
+        bool ownschecks;
+
+        MultiCheckREInfo(const std::vector<SingleCheckREInfo<TStr, TIter>*>& checks, std::optional<DFAProductExecutor<TStr, TIter>> product) : ComponentCheckREInfo<TStr, TIter>(), checks(checks), product(product), ownschecks(false) {;}
+        virtual ~MultiCheckREInfo()
+        {
+            if(this->ownschecks) {
+                for(auto iter = this->checks.begin(); iter != this->checks.end(); ++iter) {
+                    delete *iter;
+                }
+            }
+        }
+
+        MultiCheckREInfo(const MultiCheckREInfo& other) = delete;
+        MultiCheckREInfo& operator=(const MultiCheckREInfo& other) = delete;
 
         std::pair<std::string, std::string> getBSQIRInfo() const override final
         {
@@ -184,6 +298,7 @@ namespace brex
             return std::make_pair(bsqnf, smtre);
         }
 
+        //the checks that bind the match positions and the checks that are validated at each candidate -- plain negated checks are in the product (when there is one) so they are neither
         void splitBindingOps(std::vector<SingleCheckREInfo<TStr, TIter>*>& bindingopts, std::vector<SingleCheckREInfo<TStr, TIter>*>& checkopts)
         {
             for(auto iter = this->checks.begin(); iter != this->checks.end(); ++iter) {
@@ -191,12 +306,17 @@ namespace brex
                 if(!chk->isNegative && !chk->isFrontCheck && !chk->isBackCheck) {
                     bindingopts.push_back(chk);
                 }
+                else if(this->product.has_value() && !chk->isFrontCheck && !chk->isBackCheck) {
+                    ;
+                }
                 else {
                     checkopts.push_back(chk);
                 }
             }
         }
 
+        //forward matches are in increasing order and reverse matches in decreasing order so the intersection has to use the matching order
+        template <bool isforward>
         static std::vector<int64_t> computeSharedMatches(const std::vector<std::vector<int64_t>>& matches)
         {
             if(matches.empty()) {
@@ -206,7 +326,12 @@ namespace brex
             std::vector<int64_t> sharedmatches = matches[0];
             for(auto iter = matches.cbegin() + 1; iter != matches.cend(); ++iter) {
                 std::vector<int64_t> newmatches;
-                std::set_intersection(sharedmatches.cbegin(), sharedmatches.cend(), iter->cbegin(), iter->cend(), std::back_inserter(newmatches));
+                if constexpr(isforward) {
+                    std::set_intersection(sharedmatches.cbegin(), sharedmatches.cend(), iter->cbegin(), iter->cend(), std::back_inserter(newmatches));
+                }
+                else {
+                    std::set_intersection(sharedmatches.cbegin(), sharedmatches.cend(), iter->cbegin(), iter->cend(), std::back_inserter(newmatches), std::greater<int64_t>());
+                }
                 sharedmatches = std::move(newmatches);
             }
 
@@ -220,11 +345,33 @@ namespace brex
             });
         }
 
-        static std::vector<int64_t> validateMatchSetOptions(const std::vector<int64_t>& opts, std::vector<SingleCheckREInfo<TStr, TIter>*>& checks, TStr* sstr, int64_t spos)
+        //the positions where all of the binding checks match -- from the product in one pass if we have it, otherwise by intersecting the matches of each check
+        template <bool isforward>
+        std::vector<int64_t> bindingMatches(const std::vector<SingleCheckREInfo<TStr, TIter>*>& matchopts, TStr* sstr, int64_t spos, int64_t epos)
+        {
+            if(this->product.has_value()) {
+                return isforward ? this->product->matchForward(sstr, spos, epos) : this->product->matchReverse(sstr, spos, epos);
+            }
+
+            if(matchopts.size() == 1) {
+                return isforward ? matchopts.front()->executor.matchForward(sstr, spos, epos) : matchopts.front()->executor.matchReverse(sstr, spos, epos);
+            }
+
+            std::vector<std::vector<int64_t>> matches;
+            std::transform(matchopts.cbegin(), matchopts.cend(), std::back_inserter(matches), [sstr, spos, epos](SingleCheckREInfo<TStr, TIter>* check) {
+                return isforward ? check->executor.matchForward(sstr, spos, epos) : check->executor.matchReverse(sstr, spos, epos);
+            });
+
+            return MultiCheckREInfo::computeSharedMatches<isforward>(matches);
+        }
+
+        //keep the match positions where the checks accept the matched range -- [spos, pos] for forward matches and [pos, epos] for reverse matches
+        template <bool isforward>
+        static std::vector<int64_t> validateMatchSetOptions(const std::vector<int64_t>& opts, std::vector<SingleCheckREInfo<TStr, TIter>*>& checks, TStr* sstr, int64_t spos, int64_t epos)
         {
             std::vector<int64_t> matches;
-            std::copy_if(opts.begin(), opts.end(), std::back_inserter(matches), [sstr, spos, &checks](int64_t epos) {
-                return MultiCheckREInfo::validateOpSet(checks, sstr, spos, epos);
+            std::copy_if(opts.begin(), opts.end(), std::back_inserter(matches), [sstr, spos, epos, &checks](int64_t pos) {
+                return isforward ? MultiCheckREInfo::validateOpSet(checks, sstr, spos, pos) : MultiCheckREInfo::validateOpSet(checks, sstr, pos, epos);
             });
 
             return matches;
@@ -232,7 +379,15 @@ namespace brex
 
         bool test(TStr* sstr, int64_t spos, int64_t epos) override final
         {
-            return MultiCheckREInfo::validateOpSet(this->checks, sstr, spos, epos);
+            if(!this->product.has_value()) {
+                return MultiCheckREInfo::validateOpSet(this->checks, sstr, spos, epos);
+            }
+
+            std::vector<SingleCheckREInfo<TStr, TIter>*> matchopts;
+            std::vector<SingleCheckREInfo<TStr, TIter>*> checkops;
+            this->splitBindingOps(matchopts, checkops);
+
+            return this->product->test(sstr, spos, epos) && MultiCheckREInfo::validateOpSet(checkops, sstr, spos, epos);
         }
 
         bool testContains(TStr* sstr, int64_t spos, int64_t epos) override final
@@ -247,20 +402,9 @@ namespace brex
             std::vector<SingleCheckREInfo<TStr, TIter>*> checkops;
             this->splitBindingOps(matchopts, checkops);
 
-            std::vector<int64_t> realmatches;
-            if(matchopts.size() == 1) {
-                realmatches = matchopts.front()->executor.matchForward(sstr, spos, epos);
-            }
-            else {
-                std::vector<std::vector<int64_t>> matches;
-                std::transform(matchopts.cbegin(), matchopts.cend(), std::back_inserter(matches), [sstr, spos, epos](SingleCheckREInfo<TStr, TIter>* check) {
-                    return check->executor.matchForward(sstr, spos, epos);
-                });
-
-                realmatches = MultiCheckREInfo::computeSharedMatches(matches);
-            }
+            auto realmatches = this->bindingMatches<true>(matchopts, sstr, spos, epos);
 
-            auto validmatches = MultiCheckREInfo::validateMatchSetOptions(realmatches, checkops, sstr, spos);
+            auto validmatches = MultiCheckREInfo::validateMatchSetOptions<true>(realmatches, checkops, sstr, spos, epos);
             return !validmatches.empty();
         }
 
@@ -270,20 +414,9 @@ namespace brex
             std::vector<SingleCheckREInfo<TStr, TIter>*> checkops;
             this->splitBindingOps(matchopts, checkops);
 
-            std::vector<int64_t> realmatches;
-            if(matchopts.size() == 1) {
-                realmatches = matchopts.front()->executor.matchReverse(sstr, spos, epos);
-            }
-            else {
-                std::vector<std::vector<int64_t>> matches;
-                std::transform(matchopts.cbegin(), matchopts.cend(), std::back_inserter(matches), [sstr, spos, epos](SingleCheckREInfo<TStr, TIter>* check) {
-                    return check->executor.matchReverse(sstr, spos, epos);
-                });
+            auto realmatches = this->bindingMatches<false>(matchopts, sstr, spos, epos);
 
-                realmatches = MultiCheckREInfo::computeSharedMatches(matches);
-            }
-
-            auto validmatches = MultiCheckREInfo::validateMatchSetOptions(realmatches, checkops, sstr, spos);
+            auto validmatches = MultiCheckREInfo::validateMatchSetOptions<false>(realmatches, checkops, sstr, spos, epos);
             return !validmatches.empty();
         }
 
@@ -293,48 +426,157 @@ namespace brex
             return std::vector<std::pair<int64_t, int64_t>>{};
         }
 
+        std::optional<std::pair<int64_t, int64_t>> matchContainsFirst(TStr* sstr, int64_t spos, int64_t epos, const SpanBounds& bounds) override final
+        {
+            //CANNOT HAPPEN -- by def a matchable is a single option that is not negative or front/back marked
+            return std::nullopt;
+        }
+
+        std::optional<std::pair<int64_t, int64_t>> matchContainsLast(TStr* sstr, int64_t spos, int64_t epos, const SpanBounds& bounds) override final
+        {
+            //CANNOT HAPPEN -- by def a matchable is a single option that is not negative or front/back marked
+            return std::nullopt;
+        }
+
         std::vector<int64_t> matchFront(TStr* sstr, int64_t spos, int64_t epos) override final
         {
             std::vector<SingleCheckREInfo<TStr, TIter>*> matchopts;
             std::vector<SingleCheckREInfo<TStr, TIter>*> checkops;
             this->splitBindingOps(matchopts, checkops);
 
-            std::vector<int64_t> realmatches;
-            if(matchopts.size() == 1) {
-                realmatches = matchopts.front()->executor.matchForward(sstr, spos, epos);
+            auto realmatches = this->bindingMatches<true>(matchopts, sstr, spos, epos);
+
+            return MultiCheckREInfo::validateMatchSetOptions<true>(realmatches, checkops, sstr, spos, epos);
+        }
+
+        std::vector<int64_t> matchBack(TStr* sstr, int64_t spos, int64_t epos) override final
+        {
+            std::vector<SingleCheckREInfo<TStr, TIter>*> matchopts;
+            std::vector<SingleCheckREInfo<TStr, TIter>*> checkops;
+            this->splitBindingOps(matchopts, checkops);
+
+            auto realmatches = this->bindingMatches<false>(matchopts, sstr, spos, epos);
+
+            return MultiCheckREInfo::validateMatchSetOptions<false>(realmatches, checkops, sstr, spos, epos);
+        }
+
+        //append the validated binding matches as the product (or single binding check) visits them -- only intersecting several checks without a product needs the per check match vectors
+        template <bool isforward>
+        void validMatchesInto(std::vector<SingleCheckREInfo<TStr, TIter>*>& matchopts, std::vector<SingleCheckREInfo<TStr, TIter>*>& checkops, TStr* sstr, int64_t spos, int64_t epos, std::vector<int64_t>& matches)
+        {
+            matches.clear();
+
+            auto append = [&matches, &checkops, sstr, spos, epos](int64_t pos) {
+                if(isforward ? MultiCheckREInfo::validateOpSet(checkops, sstr, spos, pos) : MultiCheckREInfo::validateOpSet(checkops, sstr, pos, epos)) {
+                    matches.push_back(pos);
+                }
+                return true;
+            };
+
+            if(this->product.has_value()) {
+                if(checkops.empty() && isforward) {
+                    this->product->matchForwardInto(sstr, spos, epos, matches);
+                }
+                else if(checkops.empty()) {
+                    this->product->matchReverseInto(sstr, spos, epos, matches);
+                }
+                else if(isforward) {
+                    this->product->visitForward(sstr, spos, epos, append);
+                }
+                else {
+                    this->product->visitReverse(sstr, spos, epos, append);
+                }
+            }
+            else if(matchopts.size() == 1 && isforward) {
+                matchopts.front()->executor.visitForward(sstr, spos, epos, append);
+            }
+            else if(matchopts.size() == 1) {
+                matchopts.front()->executor.visitReverse(sstr, spos, epos, append);
             }
             else {
-                std::vector<std::vector<int64_t>> matches;
-                std::transform(matchopts.cbegin(), matchopts.cend(), std::back_inserter(matches), [sstr, spos, epos](SingleCheckREInfo<TStr, TIter>* check) {
-                    return check->executor.matchForward(sstr, spos, epos);
-                });
-
-                realmatches = MultiCheckREInfo::computeSharedMatches(matches);
+                auto realmatches = this->bindingMatches<isforward>(matchopts, sstr, spos, epos);
+                std::for_each(realmatches.cbegin(), realmatches.cend(), append);
             }
+        }
 
-            return MultiCheckREInfo::validateMatchSetOptions(realmatches, checkops, sstr, spos);
+        void matchFrontInto(TStr* sstr, int64_t spos, int64_t epos, std::vector<int64_t>& matches) override final
+        {
+            std::vector<SingleCheckREInfo<TStr, TIter>*> matchopts;
+            std::vector<SingleCheckREInfo<TStr, TIter>*> checkops;
+            this->splitBindingOps(matchopts, checkops);
+
+            this->validMatchesInto<true>(matchopts, checkops, sstr, spos, epos, matches);
         }
 
-        std::vector<int64_t> matchBack(TStr* sstr, int64_t spos, int64_t epos) override final
+        void matchBackInto(TStr* sstr, int64_t spos, int64_t epos, std::vector<int64_t>& matches) override final
         {
             std::vector<SingleCheckREInfo<TStr, TIter>*> matchopts;
             std::vector<SingleCheckREInfo<TStr, TIter>*> checkops;
             this->splitBindingOps(matchopts, checkops);
 
-            std::vector<int64_t> realmatches;
-            if(matchopts.size() == 1) {
-                realmatches = matchopts.front()->executor.matchReverse(sstr, spos, epos);
+            this->validMatchesInto<false>(matchopts, checkops, sstr, spos, epos, matches);
+        }
+
+        //with only the product to run the longest match is its last accepted position -- otherwise validate the candidates from the longest down and stop at the first that passes
+        std::optional<int64_t> matchFrontLongest(TStr* sstr, int64_t spos, int64_t epos) override final
+        {
+            std::vector<SingleCheckREInfo<TStr, TIter>*> matchopts;
+            std::vector<SingleCheckREInfo<TStr, TIter>*> checkops;
+            this->splitBindingOps(matchopts, checkops);
+
+            if(this->product.has_value() && checkops.empty()) {
+                return this->product->matchForwardLongest(sstr, spos, epos);
             }
-            else {
-                std::vector<std::vector<int64_t>> matches;
-                std::transform(matchopts.cbegin(), matchopts.cend(), std::back_inserter(matches), [sstr, spos, epos](SingleCheckREInfo<TStr, TIter>* check) {
-                    return check->executor.matchReverse(sstr, spos, epos);
-                });
 
-                realmatches = MultiCheckREInfo::computeSharedMatches(matches);
+            auto realmatches = this->bindingMatches<true>(matchopts, sstr, spos, epos);
+
+            auto lpos = std::find_if(realmatches.crbegin(), realmatches.crend(), [sstr, spos, &checkops](int64_t pos) {
+                return MultiCheckREInfo::validateOpSet(checkops, sstr, spos, pos);
+            });
+            return lpos != realmatches.crend() ? std::make_optional(*lpos) : std::nullopt;
+        }
+
+        std::optional<int64_t> matchBackLongest(TStr* sstr, int64_t spos, int64_t epos) override final
+        {
+            std::vector<SingleCheckREInfo<TStr, TIter>*> matchopts;
+            std::vector<SingleCheckREInfo<TStr, TIter>*> checkops;
+            this->splitBindingOps(matchopts, checkops);
+
+            if(this->product.has_value() && checkops.empty()) {
+                return this->product->matchReverseLongest(sstr, spos, epos);
             }
 
-            return MultiCheckREInfo::validateMatchSetOptions(realmatches, checkops, sstr, spos);
+            auto realmatches = this->bindingMatches<false>(matchopts, sstr, spos, epos);
+
+            auto lpos = std::find_if(realmatches.crbegin(), realmatches.crend(), [sstr, epos, &checkops](int64_t pos) {
+                return MultiCheckREInfo::validateOpSet(checkops, sstr, pos, epos);
+            });
+            return lpos != realmatches.crend() ? std::make_optional(*lpos) : std::nullopt;
+        }
+
+        //the checks do not combine into a single search pass so each boundary is tested on its own
+        void testBackEachInto(TStr* sstr, int64_t spos, int64_t epos, std::vector<bool>& marks) override final
+        {
+            this->testBackEachBoundary(sstr, spos, epos, marks);
+        }
+
+        void testFrontEachInto(TStr* sstr, int64_t spos, int64_t epos, std::vector<bool>& marks) override final
+        {
+            this->testFrontEachBoundary(sstr, spos, epos, marks);
+        }
+
+        MultiCheckREInfo* createMatchContext() const override final
+        {
+            std::vector<SingleCheckREInfo<TStr, TIter>*> cchecks;
+            std::transform(this->checks.cbegin(), this->checks.cend(), std::back_inserter(cchecks), [](const SingleCheckREInfo<TStr, TIter>* check) {
+                return check->createMatchContext();
+            });
+
+            //the product only holds the (immutable) DFAs and its iterator so a copy is independent
+            auto ctx = new MultiCheckREInfo(cchecks, this->product);
+            ctx->ownschecks = true;
+
+            return ctx;
         }
     };
 
@@ -344,6 +586,88 @@ namespace brex
         InvalidRegexStructure
     };
 
+    template <typename TStr, typename TIter, bool isunicode>
+    class REExecutor;
+
+    //Resumable iterator over the successive non-overlapping leftmost-longest matches of an executor -- each step searches on from the end of the last match
+    template <typename TStr, typename TIter, bool isunicode>
+    class REFindAllIterator
+    {
+    private:
+        REExecutor<TStr, TIter, isunicode>* executor;
+        TStr* sstr;
+        int64_t spos;
+        int64_t epos;
+
+        std::optional<std::pair<int64_t, int64_t>> curr;
+
+    public:
+        typedef std::pair<int64_t, int64_t> value_type;
+        typedef std::ptrdiff_t difference_type;
+        typedef std::input_iterator_tag iterator_category;
+
+        REFindAllIterator() : executor(nullptr), sstr(nullptr), spos(0), epos(-1), curr(std::nullopt) {;}
+        REFindAllIterator(REExecutor<TStr, TIter, isunicode>* executor, TStr* sstr, int64_t spos, int64_t epos) : executor(executor), sstr(sstr), spos(spos), epos(epos), curr(executor->matchContainsNext(sstr, spos, spos, epos)) {;}
+        ~REFindAllIterator() = default;
+
+        REFindAllIterator(const REFindAllIterator& other) = default;
+        REFindAllIterator(REFindAllIterator&& other) = default;
+
+        REFindAllIterator& operator=(const REFindAllIterator& other) = default;
+        REFindAllIterator& operator=(REFindAllIterator&& other) = default;
+
+        const value_type& operator*() const
+        {
+            return this->curr.value();
+        }
+
+        REFindAllIterator& operator++()
+        {
+            //matches are not empty so the next one starts after the (possibly multibyte) last char of this one
+            this->curr = this->executor->matchContainsNext(this->sstr, this->executor->matchContainsEndAfter(this->sstr, this->spos, this->epos, this->curr.value()), this->spos, this->epos);
+            return *this;
+        }
+
+        void operator++(int)
+        {
+            ++(*this);
+        }
+
+        friend bool operator==(const REFindAllIterator& iter, std::default_sentinel_t)
+        {
+            return !iter.curr.has_value();
+        }
+    };
+
+    //The matches of findAll as a range -- they are found one at a time as it is iterated
+    template <typename TStr, typename TIter, bool isunicode>
+    class REFindAllRange
+    {
+    private:
+        REExecutor<TStr, TIter, isunicode>* executor;
+        TStr* sstr;
+        int64_t spos;
+        int64_t epos;
+
+    public:
+        REFindAllRange(REExecutor<TStr, TIter, isunicode>* executor, TStr* sstr, int64_t spos, int64_t epos) : executor(executor), sstr(sstr), spos(spos), epos(epos) {;}
+        ~REFindAllRange() = default;
+
+        REFindAllIterator<TStr, TIter, isunicode> begin() const
+        {
+            if(this->executor == nullptr) {
+                return REFindAllIterator<TStr, TIter, isunicode>();
+            }
+
+            return REFindAllIterator<TStr, TIter, isunicode>(this->executor, this->sstr, this->spos, this->epos);
+        }
+
+        std::default_sentinel_t end() const
+        {
+            return std::default_sentinel;
+        }
+    };
+
     template <typename TStr, typename TIter, bool isunicode>
     class REExecutor
     {
@@ -354,8 +678,54 @@ namespace brex
         ComponentCheckREInfo<TStr, TIter>* optPost;
         ComponentCheckREInfo<TStr, TIter>* re;
 
-        REExecutor(const Regex* declre, ComponentCheckREInfo<TStr, TIter>* optPre, ComponentCheckREInfo<TStr, TIter>* optPost, ComponentCheckREInfo<TStr, TIter>* re) : declre(declre), optPre(optPre), optPost(optPost), re(re) {;}
-        ~REExecutor() = default;
+        //pre re post as a single plain check so the anchored test ops are one pass (nullptr if the parts cannot be combined)
+        SingleCheckREInfo<TStr, TIter>* anchored;
+
+        //reused buffer for the candidate positions that have to be checked against an anchor
+        std::vector<int64_t> candidates;
+
+        //reused buffer for the matches that replace and split work on -- as [start, end) so the multibyte last char of a match is covered
+        std::vector<std::pair<int64_t, int64_t>> spans;
+
+        //reused marks of the boundaries of [boundsspos, boundsepos] in boundsstr where the pre anchor accepts what is before them (and the post anchor what is after them) -- kept for the later steps of a findAll
+        std::vector<bool> prebounds;
+        std::vector<bool> postbounds;
+        TStr* boundsstr;
+        int64_t boundsspos;
+        int64_t boundsepos;
+
+        //true for a match context (which made its own copies of the components)
+        bool ownscomponents;
+
+        REExecutor(const Regex* declre, ComponentCheckREInfo<TStr, TIter>* optPre, ComponentCheckREInfo<TStr, TIter>* optPost, ComponentCheckREInfo<TStr, TIter>* re, SingleCheckREInfo<TStr, TIter>* anchored) : declre(declre), optPre(optPre), optPost(optPost), re(re), anchored(anchored), candidates(), spans(), prebounds(), postbounds(), boundsstr(nullptr), boundsspos(0), boundsepos(-1), ownscomponents(false) {;}
+        ~REExecutor()
+        {
+            if(this->ownscomponents) {
+                delete this->optPre;
+                delete this->optPost;
+                delete this->re;
+                delete this->anchored;
+            }
+        }
+
+        REExecutor(const REExecutor& other) = delete;
+        REExecutor& operator=(const REExecutor& other) = delete;
+
+        //An executor keeps per match state (so a single one cannot be used from several threads at once) but the compiled machines behind it are never modified
+        //a match context is a new executor over the same compiled machines with its own state -- so one compiled executor can be shared by many threads that each match with their own context
+        //the caller owns (and deletes) the context -- it shares the compiled machines and declre with this executor
+        REExecutor* createMatchContext() const
+        {
+            auto ctx = new REExecutor(this->declre, 
+                this->optPre != nullptr ? this->optPre->createMatchContext() : nullptr, 
+                this->optPost != nullptr ? this->optPost->createMatchContext() : nullptr, 
+                this->re->createMatchContext(), 
+                this->anchored != nullptr ? this->anchored->createMatchContext() : nullptr
+            );
+            ctx->ownscomponents = true;
+
+            return ctx;
+        }
 
         std::pair<std::string, std::string> getBSQIRInfo() const 
         {
@@ -385,6 +755,18 @@ namespace brex
             if(this->optPre == nullptr && this->optPost == nullptr) {
                 return this->re->test(sstr, spos, epos);
             }
+            else if(this->anchored != nullptr) {
+                //a missing anchor does not constrain that end of the string so the composite only has to match a prefix or suffix
+                if(this->optPre == nullptr) {
+                    return this->anchored->testBack(sstr, spos, epos);
+                }
+                else if(this->optPost == nullptr) {
+                    return this->anchored->testFront(sstr, spos, epos);
+                }
+                else {
+                    return this->anchored->test(sstr, spos, epos);
+                }
+            }
             else {
                 auto opts = this->re->matchContains(sstr, spos, epos);
 
@@ -409,14 +791,8 @@ namespace brex
                 return this->re->testContains(sstr, spos, epos);
             }
             else {
-                auto opts = this->re->matchContains(sstr, spos, epos);
-
-                return std::any_of(opts.cbegin(), opts.cend(), [this, sstr, spos, epos](const std::pair<int64_t, int64_t>& opt) {
-                    bool prechk = this->optPre == nullptr || this->optPre->testBack(sstr, spos, opt.first - 1);
-                    bool postchk = this->optPost == nullptr || this->optPost->testFront(sstr, opt.second + 1, epos);
-
-                    return prechk && postchk;
-                });
+                //the anchored composite has no search machines so stop at the first span of re that passes the anchors
+                return this->matchContainsNext(sstr, spos, spos, epos).has_value();
             }
         }
 
@@ -431,10 +807,13 @@ namespace brex
             if(this->optPost == nullptr) {
                 return this->re->testFront(sstr, spos, epos);
             }
+            else if(this->anchored != nullptr) {
+                return this->anchored->testFront(sstr, spos, epos);
+            }
             else {
-                auto opts = this->re->matchFront(sstr, spos, epos);
+                this->re->matchFrontInto(sstr, spos, epos, this->candidates);
 
-                return std::any_of(opts.cbegin(), opts.cend(), [this, sstr, epos](const int64_t opt) {
+                return std::any_of(this->candidates.cbegin(), this->candidates.cend(), [this, sstr, epos](const int64_t opt) {
                     return this->optPost->testFront(sstr, opt + 1, epos);
                 });
             }
@@ -451,10 +830,13 @@ namespace brex
             if(this->optPre == nullptr) {
                 return this->re->testBack(sstr, spos, epos);
             }
+            else if(this->anchored != nullptr) {
+                return this->anchored->testBack(sstr, spos, epos);
+            }
             else {
-                auto opts = this->re->matchBack(sstr, spos, epos);
+                this->re->matchBackInto(sstr, spos, epos, this->candidates);
 
-                return std::any_of(opts.cbegin(), opts.cend(), [this, sstr, spos](const int64_t opt) {
+                return std::any_of(this->candidates.cbegin(), this->candidates.cend(), [this, sstr, spos](const int64_t opt) {
                     return this->optPre->testBack(sstr, spos, opt - 1);
                 });
             }
@@ -468,130 +850,213 @@ namespace brex
                 return std::nullopt;
             }
 
-            std::vector<std::pair<int64_t, int64_t>> mmr;
-            if(this->optPre == nullptr && this->optPost == nullptr) {
-                mmr = this->re->matchContains(sstr, spos, epos);
-            }
-            else {
-                auto opts = this->re->matchContains(sstr, spos, epos);
-
-                std::copy_if(opts.cbegin(), opts.cend(), std::back_inserter(mmr), [this, sstr, spos, epos](const std::pair<int64_t, int64_t>& opt) {
-                    bool prechk = this->optPre == nullptr || this->optPre->testBack(sstr, spos, opt.first - 1);
-                    bool postchk = this->optPost == nullptr || this->optPost->testFront(sstr, opt.second + 1, epos);
+            return this->matchContainsNext(sstr, spos, spos, epos);
+        }
 
-                    return prechk && postchk;
-                });
+        std::optional<std::pair<int64_t, int64_t>> matchContainsLast(TStr* sstr, int64_t spos, int64_t epos, ExecutorError& error)
+        {
+            error = ExecutorError::Ok;
+            if(!this->declre->canUseInContains()) {
+                error = ExecutorError::InvalidRegexStructure;
+                return std::nullopt;
             }
 
-            if(mmr.empty()) {
+            return this->matchContainsPrev(sstr, epos, spos, epos);
+        }
+
+        std::optional<int64_t> matchFront(TStr* sstr, int64_t spos, int64_t epos, ExecutorError& error)
+        {
+            error = ExecutorError::Ok;
+            if(!this->declre->canStartsOperation()) {
+                error = ExecutorError::InvalidRegexStructure;
                 return std::nullopt;
             }
 
-            std::sort(mmr.begin(), mmr.end(), [](const std::pair<int64_t, int64_t>& a, const std::pair<int64_t, int64_t>& b) {
-                return a.first < b.first;
-            });
-            auto midx = mmr.front().first;
+            if(this->optPost == nullptr) {
+                return this->re->matchFrontLongest(sstr, spos, epos);
+            }
 
-            std::vector<std::pair<int64_t, int64_t>> minmmr;
-            std::copy_if(mmr.cbegin(), mmr.cend(), std::back_inserter(minmmr), [midx](const std::pair<int64_t, int64_t>& opt) {
-                return opt.first == midx;
-            });
+            //only the longest candidate that the anchor accepts is needed so check them from the longest down
+            this->re->matchFrontInto(sstr, spos, epos, this->candidates);
 
-            std::sort(minmmr.begin(), minmmr.end(), [](const std::pair<int64_t, int64_t>& a, const std::pair<int64_t, int64_t>& b) {
-                return a.second < b.second;
+            auto lpos = std::find_if(this->candidates.crbegin(), this->candidates.crend(), [this, sstr, epos](const int64_t opt) {
+                return this->optPost->testFront(sstr, opt + 1, epos);
             });
-
-            return std::make_optional(minmmr.back());
+            return lpos != this->candidates.crend() ? std::make_optional(*lpos) : std::nullopt;
         }
 
-        std::optional<std::pair<int64_t, int64_t>> matchContainsLast(TStr* sstr, int64_t spos, int64_t epos, ExecutorError& error)
+        std::optional<int64_t> matchBack(TStr* sstr, int64_t spos, int64_t epos, ExecutorError& error)
         {
             error = ExecutorError::Ok;
-            if(!this->declre->canUseInContains()) {
+            if(!this->declre->canEndOperation()) {
                 error = ExecutorError::InvalidRegexStructure;
                 return std::nullopt;
             }
 
-            std::vector<std::pair<int64_t, int64_t>> mmr;
-            if(this->optPre == nullptr && this->optPost == nullptr) {
-                mmr = this->re->matchContains(sstr, spos, epos);
+            if(this->optPre == nullptr) {
+                return this->re->matchBackLongest(sstr, spos, epos);
             }
-            else {
-                auto opts = this->re->matchContains(sstr, spos, epos);
 
-                std::copy_if(opts.cbegin(), opts.cend(), std::back_inserter(mmr), [this, sstr, spos, epos](const std::pair<int64_t, int64_t>& opt) {
-                    bool prechk = this->optPre == nullptr || this->optPre->testBack(sstr, spos, opt.first - 1);
-                    bool postchk = this->optPost == nullptr || this->optPost->testFront(sstr, opt.second + 1, epos);
+            this->re->matchBackInto(sstr, spos, epos, this->candidates);
 
-                    return prechk && postchk;
-                });
+            auto lpos = std::find_if(this->candidates.crbegin(), this->candidates.crend(), [this, sstr, spos](const int64_t opt) {
+                return this->optPre->testBack(sstr, spos, opt - 1);
+            });
+            return lpos != this->candidates.crend() ? std::make_optional(*lpos) : std::nullopt;
+        }
+
+        //the index just after a match -- its last index is the first byte of its last char so step over the rest of that char
+        int64_t matchContainsEndAfter(TStr* sstr, int64_t spos, int64_t epos, const std::pair<int64_t, int64_t>& match) const
+        {
+            TIter eiter{sstr, spos, epos, match.second};
+            eiter.inc();
+
+            return eiter.curr;
+        }
+
+        //the boundaries of [spos, epos] that the anchors accept -- marked in one pass per anchor when a search starts (fresh) or the range changes and reused by the later steps of a findAll
+        SpanBounds anchorBounds(TStr* sstr, int64_t spos, int64_t epos, bool fresh)
+        {
+            if(fresh || sstr != this->boundsstr || spos != this->boundsspos || epos != this->boundsepos) {
+                if(this->optPre != nullptr) {
+                    this->optPre->testBackEachInto(sstr, spos, epos, this->prebounds);
+                }
+                if(this->optPost != nullptr) {
+                    this->optPost->testFrontEachInto(sstr, spos, epos, this->postbounds);
+                }
+
+                this->boundsstr = sstr;
+                this->boundsspos = spos;
+                this->boundsepos = epos;
             }
 
-            if(mmr.empty()) {
+            return SpanBounds(spos, this->optPre != nullptr ? &this->prebounds : nullptr, this->optPost != nullptr ? &this->postbounds : nullptr);
+        }
+
+        //the leftmost (and then longest) match that starts at or after from -- the anchors are checked against all of [spos, epos]
+        //the search on re only starts and ends matches at the boundaries the anchors accept so it is a single pass (and never runs an anchored match from each start)
+        std::optional<std::pair<int64_t, int64_t>> matchContainsNext(TStr* sstr, int64_t from, int64_t spos, int64_t epos)
+        {
+            if(from > epos) {
                 return std::nullopt;
             }
 
-            std::sort(mmr.begin(), mmr.end(), [](const std::pair<int64_t, int64_t>& a, const std::pair<int64_t, int64_t>& b) {
-                return a.second < b.second;
-            });
-            auto midx = mmr.back().second;
+            if(this->optPre == nullptr && this->optPost == nullptr) {
+                return this->re->matchContainsFirst(sstr, from, epos, SpanBounds());
+            }
 
-            std::vector<std::pair<int64_t, int64_t>> maxmmr;
-            std::copy_if(mmr.cbegin(), mmr.cend(), std::back_inserter(maxmmr), [midx](const std::pair<int64_t, int64_t>& opt) {
-                return opt.second == midx;
-            });
+            return this->re->matchContainsFirst(sstr, from, epos, this->anchorBounds(sstr, spos, epos, from == spos));
+        }
 
-            std::sort(maxmmr.begin(), maxmmr.end(), [](const std::pair<int64_t, int64_t>& a, const std::pair<int64_t, int64_t>& b) {
-                return a.first < b.first;
-            });
+        //the rightmost (and then longest) match that ends at or before to -- the reverse of matchContainsNext
+        std::optional<std::pair<int64_t, int64_t>> matchContainsPrev(TStr* sstr, int64_t to, int64_t spos, int64_t epos)
+        {
+            if(to < spos) {
+                return std::nullopt;
+            }
+
+            if(this->optPre == nullptr && this->optPost == nullptr) {
+                return this->re->matchContainsLast(sstr, spos, to, SpanBounds());
+            }
 
-            return std::make_optional(maxmmr.front());
+            return this->re->matchContainsLast(sstr, spos, to, this->anchorBounds(sstr, spos, epos, to == epos));
         }
 
-        std::optional<int64_t> matchFront(TStr* sstr, int64_t spos, int64_t epos, ExecutorError& error)
+        //the successive non-overlapping leftmost-longest matches in [spos, epos] -- each is found when the range is advanced to it so the input is scanned once
+        REFindAllRange<TStr, TIter, isunicode> findAll(TStr* sstr, int64_t spos, int64_t epos, ExecutorError& error)
         {
             error = ExecutorError::Ok;
-            if(!this->declre->canStartsOperation()) {
+            if(!this->declre->canUseInContains()) {
                 error = ExecutorError::InvalidRegexStructure;
-                return std::nullopt;
+                return REFindAllRange<TStr, TIter, isunicode>(nullptr, sstr, spos, epos);
             }
 
-            std::vector<int64_t> mmr;
-            if(this->optPost == nullptr) {
-                mmr = this->re->matchFront(sstr, spos, epos);
+            return REFindAllRange<TStr, TIter, isunicode>(this, sstr, spos, epos);
+        }
+
+        //collect (at most limit of) the successive matches into spans (as [start, end)) in one pass
+        void collectMatches(TStr* sstr, int64_t spos, int64_t epos, size_t limit)
+        {
+            this->spans.clear();
+
+            //the same steps as findAll but the end of each match is computed once and kept for the next search
+            auto curr = this->matchContainsNext(sstr, spos, spos, epos);
+            while(curr.has_value()) {
+                const int64_t end = this->matchContainsEndAfter(sstr, spos, epos, curr.value());
+                this->spans.push_back(std::make_pair(curr->first, end));
+                if(this->spans.size() == limit) {
+                    break;
+                }
+                curr = this->matchContainsNext(sstr, end, spos, epos);
             }
-            else {
-                auto opts = this->re->matchFront(sstr, spos, epos);
+        }
 
-                std::copy_if(opts.cbegin(), opts.cend(), std::back_inserter(mmr), [this, sstr, epos](const int64_t opt) {
-                    return this->optPost->testFront(sstr, opt + 1, epos);
-                });
+        //write sstr to out with (at most limit of) the matches in [spos, epos] replaced -- out is sized once from the matches and filled in a single copy pass
+        size_t replaceMatches(TStr* sstr, int64_t spos, int64_t epos, const TStr& replacement, TStr& out, size_t limit)
+        {
+            this->collectMatches(sstr, spos, epos, limit);
+
+            size_t outsize = sstr->size();
+            for(auto iter = this->spans.cbegin(); iter != this->spans.cend(); ++iter) {
+                outsize = (outsize - (size_t)(iter->second - iter->first)) + replacement.size();
             }
+            out.resize(outsize);
+
+            auto optr = out.begin();
+            int64_t from = 0;
+            for(auto iter = this->spans.cbegin(); iter != this->spans.cend(); ++iter) {
+                optr = std::copy(sstr->cbegin() + from, sstr->cbegin() + iter->first, optr);
+                optr = std::copy(replacement.cbegin(), replacement.cend(), optr);
+                from = iter->second;
+            }
+            std::copy(sstr->cbegin() + from, sstr->cend(), optr);
 
-            return !mmr.empty() ? std::make_optional(mmr.back()) : std::nullopt;
+            return this->spans.size();
         }
 
-        std::optional<int64_t> matchBack(TStr* sstr, int64_t spos, int64_t epos, ExecutorError& error)
+        //replace every match in [spos, epos] (as found by findAll) and return how many there were
+        size_t replaceAll(TStr* sstr, int64_t spos, int64_t epos, const TStr& replacement, TStr& out, ExecutorError& error)
         {
             error = ExecutorError::Ok;
-            if(!this->declre->canEndOperation()) {
+            if(!this->declre->canUseInContains()) {
                 error = ExecutorError::InvalidRegexStructure;
-                return std::nullopt;
+                return 0;
             }
 
-            std::vector<int64_t> mmr;
-            if(this->optPre == nullptr) {
-                mmr = this->re->matchBack(sstr, spos, epos);
+            return this->replaceMatches(sstr, spos, epos, replacement, out, SIZE_MAX);
+        }
+
+        //replace the leftmost-longest match in [spos, epos] (if any) and return how many there were
+        size_t replaceFirst(TStr* sstr, int64_t spos, int64_t epos, const TStr& replacement, TStr& out, ExecutorError& error)
+        {
+            error = ExecutorError::Ok;
+            if(!this->declre->canUseInContains()) {
+                error = ExecutorError::InvalidRegexStructure;
+                return 0;
             }
-            else {
-                auto opts = this->re->matchBack(sstr, spos, epos);
 
-                std::copy_if(opts.cbegin(), opts.cend(), std::back_inserter(mmr), [this, sstr, spos](const int64_t opt) {
-                    return this->optPre->testBack(sstr, spos, opt - 1);
-                });
+            return this->replaceMatches(sstr, spos, epos, replacement, out, 1);
+        }
+
+        //the (first, last) indices of the pieces of [spos, epos] between the matches -- an empty piece is (first, first - 1)
+        void split(TStr* sstr, int64_t spos, int64_t epos, std::vector<std::pair<int64_t, int64_t>>& parts, ExecutorError& error)
+        {
+            parts.clear();
+
+            error = ExecutorError::Ok;
+            if(!this->declre->canUseInContains()) {
+                error = ExecutorError::InvalidRegexStructure;
+                return;
             }
 
-            return !mmr.empty() ? std::make_optional(mmr.back()) : std::nullopt;
+            this->collectMatches(sstr, spos, epos, SIZE_MAX);
+
+            int64_t from = spos;
+            for(auto iter = this->spans.cbegin(); iter != this->spans.cend(); ++iter) {
+                parts.push_back(std::make_pair(from, iter->first - 1));
+                from = iter->second;
+            }
+            parts.push_back(std::make_pair(from, epos));
         }
 
         bool test(TStr* sstr, ExecutorError& error) { return this->test(sstr, 0, (int64_t)sstr->size() - 1, error); }
@@ -602,8 +1067,14 @@ namespace brex
 
         std::optional<std::pair<int64_t, int64_t>> matchContainsFirst(TStr* sstr, ExecutorError& error) { return this->matchContainsFirst(sstr, 0, (int64_t)sstr->size() - 1, error); }
         std::optional<std::pair<int64_t, int64_t>> matchContainsLast(TStr* sstr, ExecutorError& error) { return this->matchContainsLast(sstr, 0, (int64_t)sstr->size() - 1, error); }
+
         std::optional<int64_t> matchFront(TStr* sstr, ExecutorError& error) { return this->matchFront(sstr, 0, (int64_t)sstr->size() - 1, error); }
         std::optional<int64_t> matchBack(TStr* sstr, ExecutorError& error) { return this->matchBack(sstr, 0, (int64_t)sstr->size() - 1, error); }
+
+        REFindAllRange<TStr, TIter, isunicode> findAll(TStr* sstr, ExecutorError& error) { return this->findAll(sstr, 0, (int64_t)sstr->size() - 1, error); }
+        size_t replaceAll(TStr* sstr, const TStr& replacement, TStr& out, ExecutorError& error) { return this->replaceAll(sstr, 0, (int64_t)sstr->size() - 1, replacement, out, error); }
+        size_t replaceFirst(TStr* sstr, const TStr& replacement, TStr& out, ExecutorError& error) { return this->replaceFirst(sstr, 0, (int64_t)sstr->size() - 1, replacement, out, error); }
+        void split(TStr* sstr, std::vector<std::pair<int64_t, int64_t>>& parts, ExecutorError& error) { this->split(sstr, 0, (int64_t)sstr->size() - 1, parts, error); }
     };
 
     typedef REExecutor<UnicodeString, UnicodeRegexIterator, true> UnicodeRegexExecutor;
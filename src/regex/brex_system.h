@@ -392,5 +392,18 @@ namespace brex
             auto uentry = static_cast<ReSystemCEntry*>(*iter);
             return uentry->executor;
         }
+
+        //the compiled executors are shared -- each thread that matches with an entry creates (and deletes) its own match context for it
+        UnicodeRegexExecutor* createUnicodeREContext(const std::string& fullname) const
+        {
+            auto executor = this->getUnicodeRE(fullname);
+            return executor != nullptr ? executor->createMatchContext() : nullptr;
+        }
+
+        CRegexExecutor* createCStringREContext(const std::string& fullname) const
+        {
+            auto executor = this->getCStringRE(fullname);
+            return executor != nullptr ? executor->createMatchContext() : nullptr;
+        }
     };
 }
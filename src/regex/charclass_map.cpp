@@ -0,0 +1,110 @@
+#include "charclass_map.h"
+
+#include <algorithm>
+
+namespace brex
+{
+    CharClassMap::CharClassMap(const std::vector<RegexChar>& boundaries) : boundaries(boundaries), byteclasses(CHAR_CLASS_BYTE_TABLE_SIZE, 0), pagedlimit(CHAR_CLASS_BYTE_TABLE_SIZE), pageindex(), pages()
+    {
+        size_t cls = 0;
+        for(size_t i = 0; i < CHAR_CLASS_BYTE_TABLE_SIZE; ++i) {
+            while(cls + 1 < this->boundaries.size() && this->boundaries[cls + 1] <= (RegexChar)i) {
+                cls++;
+            }
+            this->byteclasses[i] = (uint8_t)cls;
+        }
+
+        if(this->boundaries.back() <= CHAR_CLASS_BYTE_TABLE_SIZE || this->boundaries.size() > CHAR_CLASS_MAX_PAGED_CLASSES) {
+            return;
+        }
+
+        const size_t lastpage = ((size_t)this->boundaries.back() + CHAR_CLASS_PAGE_SIZE - 1) / CHAR_CLASS_PAGE_SIZE;
+        this->pagedlimit = (RegexChar)(std::min<size_t>(lastpage * CHAR_CLASS_PAGE_SIZE, CHAR_CLASS_PAGED_LIMIT));
+
+        //pages that are entirely in one class are shared -- the others are built explicitly (the pages under the byte table are never used)
+        std::map<size_t, uint16_t> uniformpages;
+        this->pageindex.resize(this->pagedlimit / CHAR_CLASS_PAGE_SIZE, 0);
+
+        cls = 0;
+        for(size_t p = CHAR_CLASS_BYTE_TABLE_SIZE / CHAR_CLASS_PAGE_SIZE; p < this->pageindex.size(); ++p) {
+            const RegexChar pstart = (RegexChar)(p * CHAR_CLASS_PAGE_SIZE);
+            const RegexChar pend = pstart + CHAR_CLASS_PAGE_SIZE;
+
+            while(cls + 1 < this->boundaries.size() && this->boundaries[cls + 1] <= pstart) {
+                cls++;
+            }
+
+            if(cls + 1 == this->boundaries.size() || pend <= this->boundaries[cls + 1]) {
+                auto ii = uniformpages.find(cls);
+                if(ii == uniformpages.end()) {
+                    ii = uniformpages.insert({ cls, (uint16_t)(this->pages.size() / CHAR_CLASS_PAGE_SIZE) }).first;
+                    this->pages.resize(this->pages.size() + CHAR_CLASS_PAGE_SIZE, (uint16_t)cls);
+                }
+
+                this->pageindex[p] = ii->second;
+            }
+            else {
+                this->pageindex[p] = (uint16_t)(this->pages.size() / CHAR_CLASS_PAGE_SIZE);
+
+                size_t pcls = cls;
+                for(RegexChar c = pstart; c < pend; ++c) {
+                    while(pcls + 1 < this->boundaries.size() && this->boundaries[pcls + 1] <= c) {
+                        pcls++;
+                    }
+                    this->pages.push_back((uint16_t)pcls);
+                }
+            }
+        }
+    }
+
+    size_t CharClassMap::searchClassOf(RegexChar c) const
+    {
+        return (size_t)(std::distance(this->boundaries.cbegin(), std::upper_bound(this->boundaries.cbegin(), this->boundaries.cend(), c)) - 1);
+    }
+
+    CharClassMap CharClassMap::build(const NFAProgram& program)
+    {
+        return CharClassMap::build(std::vector<const NFAProgram*>{ &program });
+    }
+
+    void CharClassMap::addBoundaries(const NFAProgram& program, std::vector<RegexChar>& boundaries)
+    {
+        for(StateID s = 0; s < program.size(); ++s) {
+            if(program.tags[s] == NFAOptTag::CharCode) {
+                boundaries.push_back(program.operands[s]);
+                boundaries.push_back(program.operands[s] + 1);
+            }
+            else if(program.tags[s] == NFAOptTag::CharRange) {
+                const NFAProgramRangeSet& rset = program.rangesets[program.operands[s]];
+                for(uint32_t i = rset.start; i < rset.start + rset.count; ++i) {
+                    boundaries.push_back(program.ranges[i].low);
+                    boundaries.push_back(program.ranges[i].high + 1);
+                }
+            }
+            else {
+                ;
+            }
+        }
+    }
+
+    CharClassMap CharClassMap::build(const std::vector<const NFAProgram*>& programs)
+    {
+        std::vector<RegexChar> boundaries = { 0 };
+        for(auto piter = programs.cbegin(); piter != programs.cend(); ++piter) {
+            CharClassMap::addBoundaries(**piter, boundaries);
+        }
+
+        std::sort(boundaries.begin(), boundaries.end());
+        boundaries.erase(std::unique(boundaries.begin(), boundaries.end()), boundaries.end());
+
+        return CharClassMap(boundaries);
+    }
+
+    bool CharClassMap::separates(const NFAProgram& program) const
+    {
+        std::vector<RegexChar> pboundaries;
+        CharClassMap::addBoundaries(program, pboundaries);
+
+        return std::all_of(pboundaries.cbegin(), pboundaries.cend(), [this](RegexChar b) { return std::binary_search(this->boundaries.cbegin(), this->boundaries.cend(), b); });
+    }
+}
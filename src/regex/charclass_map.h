@@ -0,0 +1,94 @@
+#pragma once
+
+#include "../common.h"
+
+#include "nfa_machine.h"
+
+#include <memory>
+
+namespace brex
+{
+    //chars below this are mapped to their class with a single table lookup -- class i starts at char i or later so the ids of these chars fit in a byte
+    #define CHAR_CLASS_BYTE_TABLE_SIZE 256
+
+    //chars below this (all of Unicode) are mapped with a two level table of 256 char pages -- larger values fall back to a binary search
+    #define CHAR_CLASS_PAGE_SIZE 256
+    #define CHAR_CLASS_PAGED_LIMIT 0x110000
+
+    //the pages hold 16 bit class ids -- a map with more classes than this (only for huge sets of disjoint ranges) always uses the binary search above the byte table
+    #define CHAR_CLASS_MAX_PAGED_CLASSES 65536
+
+    //A partition of the char space into equivalence classes -- all chars in a class are accepted by exactly the same char tests of a machine
+    //one map is built for each regex and shared by all of its DFA, bit-parallel, and lazy DFA machines
+    class CharClassMap
+    {
+    private:
+        //sorted starts of the classes -- class i is the chars in [boundaries[i], boundaries[i + 1])
+        std::vector<RegexChar> boundaries;
+
+        std::vector<uint8_t> byteclasses;
+
+        //the chars from the byte table up to pagedlimit (the last boundary rounded up to a page) are mapped with the page of each CHAR_CLASS_PAGE_SIZE block and the (deduplicated) pages
+        //so a regex that only tests ascii or Latin-1 chars has no pages and one that tests a few other chars only has pages up to the largest of them
+        RegexChar pagedlimit;
+        std::vector<uint16_t> pageindex;
+        std::vector<uint16_t> pages;
+
+        size_t searchClassOf(RegexChar c) const;
+
+        static void addBoundaries(const NFAProgram& program, std::vector<RegexChar>& boundaries);
+
+    public:
+        CharClassMap() : boundaries({ 0 }), byteclasses(CHAR_CLASS_BYTE_TABLE_SIZE, 0), pagedlimit(CHAR_CLASS_BYTE_TABLE_SIZE), pageindex(), pages() {;}
+        CharClassMap(const std::vector<RegexChar>& boundaries);
+        ~CharClassMap() = default;
+
+        CharClassMap(const CharClassMap& other) = default;
+        CharClassMap(CharClassMap&& other) = default;
+
+        CharClassMap& operator=(const CharClassMap& other) = default;
+        CharClassMap& operator=(CharClassMap&& other) = default;
+
+        //partition the chars by all of the char code and range tests in the program
+        static CharClassMap build(const NFAProgram& program);
+
+        //partition the chars by the tests in all of the programs (for machines that are run together)
+        static CharClassMap build(const std::vector<const NFAProgram*>& programs);
+
+        //true if every char code and range test in the program accepts all or none of the chars in each class (so a machine for it can run on this map)
+        bool separates(const NFAProgram& program) const;
+
+        //bytes used by the tables
+        size_t footprint() const
+        {
+            return (this->boundaries.size() * sizeof(RegexChar)) + (this->byteclasses.size() * sizeof(uint8_t)) + (this->pageindex.size() * sizeof(uint16_t)) + (this->pages.size() * sizeof(uint16_t));
+        }
+
+        inline size_t classcount() const
+        {
+            return this->boundaries.size();
+        }
+
+        //the smallest char in the class
+        inline RegexChar representative(size_t cls) const
+        {
+            return this->boundaries[cls];
+        }
+
+        inline size_t classOf(RegexChar c) const
+        {
+            if(c < CHAR_CLASS_BYTE_TABLE_SIZE) {
+                return this->byteclasses[c];
+            }
+            else if(c < this->pagedlimit) {
+                return this->pages[((size_t)this->pageindex[c / CHAR_CLASS_PAGE_SIZE] * CHAR_CLASS_PAGE_SIZE) + (c % CHAR_CLASS_PAGE_SIZE)];
+            }
+            else if(c >= this->boundaries.back()) {
+                return this->boundaries.size() - 1;
+            }
+            else {
+                return this->searchClassOf(c);
+            }
+        }
+    };
+}
@@ -0,0 +1,374 @@
+#include "dfa_machine.h"
+
+#include <algorithm>
+
+namespace brex
+{
+    bool LazyDFAMachine::canDeterminize(const NFAMachine* m)
+    {
+        return m->program.counters.empty();
+    }
+
+    DFAStateID LazyDFAMachine::addState(const std::vector<StateID>& nfastates)
+    {
+        auto ii = this->stateids.find(nfastates);
+        if(ii != this->stateids.end()) {
+            return ii->second;
+        }
+
+        const DFAStateID s = (DFAStateID)this->states.size();
+        this->states.push_back(nfastates);
+        this->accepting.push_back(std::binary_search(nfastates.cbegin(), nfastates.cend(), this->m->acceptstate));
+        this->universal.push_back(std::any_of(nfastates.cbegin(), nfastates.cend(), [this](StateID s) { return (bool)this->m->universalstates[s]; }));
+        this->idle.push_back(this->hasidle && nfastates == this->idlekey);
+        this->stateids.insert({ nfastates, s });
+        this->transitions.resize(this->transitions.size() + this->classes->classcount(), DFA_UNKNOWN_STATE);
+
+        return s;
+    }
+
+    void LazyDFAMachine::flushCache()
+    {
+        this->states.clear();
+        this->accepting.clear();
+        this->universal.clear();
+        this->idle.clear();
+        this->stateids.clear();
+        this->transitions.clear();
+
+        //the dead state is always DFA_DEAD_STATE
+        this->scratchkey.clear();
+        this->addState(this->scratchkey);
+
+        this->m->intitializeMachine(this->cstates, this->workset, this->fixpoint);
+        this->scratchkey.assign(this->cstates.simplestates.cbegin(), this->cstates.simplestates.cend());
+        std::sort(this->scratchkey.begin(), this->scratchkey.end());
+        this->startstate = this->addState(this->scratchkey);
+    }
+
+    void LazyDFAMachine::buildCache()
+    {
+        this->flushCache();
+
+        if(this->markedidle) {
+            const DFAStateID s = this->stepMachine(this->startstate, this->idlechar);
+            this->idlekey = this->states[s];
+            this->hasidle = true;
+            this->idle[s] = true;
+        }
+    }
+
+    void LazyDFAMachine::markIdle(RegexChar c)
+    {
+        this->markedidle = true;
+        this->idlechar = c;
+    }
+
+    DFAStateID LazyDFAMachine::computeTransition(DFAStateID s, RegexChar c, size_t cls)
+    {
+        const std::vector<StateID>& ostates = this->states[s];
+
+        this->cstates.intitialize(this->m->program.size());
+        for(auto iter = ostates.cbegin(); iter != ostates.cend(); ++iter) {
+            this->cstates.simplestates.insert(*iter);
+        }
+
+        this->m->stepMachine(c, this->cstates, this->nstates, this->workset, this->fixpoint);
+        this->scratchkey.assign(this->nstates.simplestates.cbegin(), this->nstates.simplestates.cend());
+        std::sort(this->scratchkey.begin(), this->scratchkey.end());
+
+        bool flushed = false;
+        if(this->states.size() >= this->maxstates && this->stateids.find(this->scratchkey) == this->stateids.end()) {
+            this->searchflushes++;
+            if(this->searchflushes > LAZY_DFA_MAX_FLUSHES_PER_SEARCH) {
+                //cache is thrashing so the NFA will be cheaper -- stop here and have the caller rerun the search
+                this->disabled = true;
+                return DFA_DEAD_STATE;
+            }
+
+            //flushCache uses scratchkey so save the new state first
+            std::vector<StateID> nkey = this->scratchkey;
+            this->flushCache();
+            this->scratchkey = nkey;
+
+            flushed = true;
+        }
+
+        const DFAStateID ns = this->addState(this->scratchkey);
+        if(!flushed) {
+            this->transitions[(s * this->classes->classcount()) + cls] = ns;
+        }
+
+        return ns;
+    }
+
+    void DFAMachine::minimize(size_t statecount, size_t classcount, const std::vector<DFAStateID>& transitions, const std::vector<bool>& accepting, std::vector<DFAStateID>& blockof, size_t& blockcount)
+    {
+        //Hopcroft partition refinement -- inverse[(c * statecount) + t] are the states that go to t on class c
+        std::vector<std::vector<DFAStateID>> inverse(classcount * statecount);
+        for(size_t s = 0; s < statecount; ++s) {
+            for(size_t c = 0; c < classcount; ++c) {
+                inverse[(c * statecount) + transitions[(s * classcount) + c]].push_back((DFAStateID)s);
+            }
+        }
+
+        std::vector<std::vector<DFAStateID>> blocks;
+        blockof.assign(statecount, 0);
+
+        std::vector<DFAStateID> accepts;
+        std::vector<DFAStateID> rejects;
+        for(size_t s = 0; s < statecount; ++s) {
+            if(accepting[s]) {
+                accepts.push_back((DFAStateID)s);
+            }
+            else {
+                rejects.push_back((DFAStateID)s);
+            }
+        }
+
+        std::vector<size_t> worklist;
+        std::vector<bool> inwork;
+        for(auto initial : { accepts, rejects }) {
+            if(!initial.empty()) {
+                for(auto iter = initial.cbegin(); iter != initial.cend(); ++iter) {
+                    blockof[*iter] = (DFAStateID)blocks.size();
+                }
+
+                worklist.push_back(blocks.size());
+                inwork.push_back(true);
+                blocks.push_back(initial);
+            }
+        }
+
+        std::vector<bool> marked(statecount, false);
+        std::vector<size_t> markedcount(statecount, 0);
+        std::vector<DFAStateID> predecessors;
+        std::vector<size_t> touched;
+        while(!worklist.empty()) {
+            const size_t splitter = worklist.back();
+            worklist.pop_back();
+            inwork[splitter] = false;
+
+            //the splitter may itself be split while we process it so work on a copy
+            const std::vector<DFAStateID> splitterstates = blocks[splitter];
+            for(size_t c = 0; c < classcount; ++c) {
+                predecessors.clear();
+                for(auto iter = splitterstates.cbegin(); iter != splitterstates.cend(); ++iter) {
+                    const std::vector<DFAStateID>& preds = inverse[(c * statecount) + *iter];
+                    for(auto ii = preds.cbegin(); ii != preds.cend(); ++ii) {
+                        if(!marked[*ii]) {
+                            marked[*ii] = true;
+                            predecessors.push_back(*ii);
+                        }
+                    }
+                }
+
+                touched.clear();
+                for(auto iter = predecessors.cbegin(); iter != predecessors.cend(); ++iter) {
+                    const size_t b = blockof[*iter];
+                    if(markedcount[b] == 0) {
+                        touched.push_back(b);
+                    }
+                    markedcount[b]++;
+                }
+
+                for(auto iter = touched.cbegin(); iter != touched.cend(); ++iter) {
+                    const size_t b = *iter;
+                    if(markedcount[b] != blocks[b].size()) {
+                        std::vector<DFAStateID> inpart;
+                        std::vector<DFAStateID> outpart;
+                        for(auto ii = blocks[b].cbegin(); ii != blocks[b].cend(); ++ii) {
+                            if(marked[*ii]) {
+                                inpart.push_back(*ii);
+                            }
+                            else {
+                                outpart.push_back(*ii);
+                            }
+                        }
+
+                        const size_t nb = blocks.size();
+                        for(auto ii = inpart.cbegin(); ii != inpart.cend(); ++ii) {
+                            blockof[*ii] = (DFAStateID)nb;
+                        }
+
+                        const bool inpartsmaller = inpart.size() <= outpart.size();
+                        blocks[b] = outpart;
+                        blocks.push_back(inpart);
+                        inwork.push_back(false);
+
+                        if(inwork[b]) {
+                            worklist.push_back(nb);
+                            inwork[nb] = true;
+                        }
+                        else {
+                            const size_t addb = inpartsmaller ? nb : b;
+                            worklist.push_back(addb);
+                            inwork[addb] = true;
+                        }
+                    }
+
+                    markedcount[b] = 0;
+                }
+
+                for(auto iter = predecessors.cbegin(); iter != predecessors.cend(); ++iter) {
+                    marked[*iter] = false;
+                }
+            }
+        }
+
+        blockcount = blocks.size();
+    }
+
+    DFAMachine* DFAMachine::tryCompile(const NFAMachine* m, size_t statebudget)
+    {
+        return DFAMachine::tryCompile(m, std::make_shared<const CharClassMap>(CharClassMap::build(m->program)), statebudget);
+    }
+
+    DFAMachine* DFAMachine::tryCompile(const NFAMachine* m, std::shared_ptr<const CharClassMap> classes, size_t statebudget)
+    {
+        return DFAMachine::tryCompileProduct({ m }, { false }, classes, statebudget);
+    }
+
+    DFAMachine* DFAMachine::tryCompileProduct(const std::vector<const NFAMachine*>& ms, const std::vector<bool>& complemented, std::shared_ptr<const CharClassMap> classes, size_t statebudget)
+    {
+        if(statebudget == 0 || !std::all_of(ms.cbegin(), ms.cend(), [](const NFAMachine* m) { return LazyDFAMachine::canDeterminize(m); })) {
+            return nullptr;
+        }
+
+        const size_t classcount = classes->classcount();
+        if(statebudget * classcount > DFA_MAX_TABLE_ENTRIES) {
+            statebudget = DFA_MAX_TABLE_ENTRIES / classcount;
+        }
+
+        std::vector<NFAState> cstates(ms.size());
+        std::vector<NFAState> nstates(ms.size());
+        NFAEpsilonWorkSet workset;
+        NFAEpsilonFixpointSet fixpoint;
+
+        //subset construction -- each class is stepped using its first char as a representative
+        //a key is the sorted NFA states of each machine with a separator after each one and any key where a (non-complemented) machine has no states is the (empty) dead key
+        //a complemented machine with no states has rejected so it is satisfied by every extension of the input
+        std::vector<std::vector<StateID>> states;
+        std::map<std::vector<StateID>, DFAStateID> stateids;
+        std::vector<DFAStateID> transitions;
+        std::vector<bool> accepting;
+
+        auto addstate = [&](const std::vector<NFAState>& nfastates) {
+            std::vector<StateID> key;
+            bool accepts = true;
+            for(size_t i = 0; i < ms.size(); ++i) {
+                if(nfastates[i].simplestates.empty() && !complemented[i]) {
+                    key.clear();
+                    accepts = false;
+                    break;
+                }
+
+                const size_t kstart = key.size();
+                key.insert(key.end(), nfastates[i].simplestates.cbegin(), nfastates[i].simplestates.cend());
+                std::sort(key.begin() + kstart, key.end());
+                accepts &= (std::binary_search(key.cbegin() + kstart, key.cend(), ms[i]->acceptstate) != complemented[i]);
+
+                key.push_back(DFA_PRODUCT_KEY_SEPARATOR);
+            }
+
+            auto ii = stateids.find(key);
+            if(ii != stateids.end()) {
+                return ii->second;
+            }
+
+            const DFAStateID s = (DFAStateID)states.size();
+            accepting.push_back(accepts);
+            stateids.insert({ key, s });
+            states.push_back(key);
+
+            return s;
+        };
+
+        for(size_t i = 0; i < ms.size(); ++i) {
+            ms[i]->intitializeMachine(cstates[i], workset, fixpoint);
+        }
+        const DFAStateID nfastart = addstate(cstates);
+        for(size_t s = 0; s < states.size(); ++s) {
+            if(states.size() > statebudget) {
+                return nullptr;
+            }
+
+            transitions.resize(transitions.size() + classcount, DFA_UNKNOWN_STATE);
+            if(states[s].empty()) {
+                //the dead key loops to itself
+                std::fill(transitions.end() - classcount, transitions.end(), (DFAStateID)s);
+                continue;
+            }
+
+            for(size_t c = 0; c < classcount; ++c) {
+                auto kiter = states[s].cbegin();
+                for(size_t i = 0; i < ms.size(); ++i) {
+                    cstates[i].intitialize(ms[i]->program.size());
+                    while(*kiter != DFA_PRODUCT_KEY_SEPARATOR) {
+                        cstates[i].simplestates.insert(*kiter);
+                        kiter++;
+                    }
+                    kiter++;
+
+                    ms[i]->stepMachine(classes->representative(c), cstates[i], nstates[i], workset, fixpoint);
+                }
+
+                transitions[(s * classcount) + c] = addstate(nstates);
+            }
+        }
+
+        if(states.size() > statebudget) {
+            return nullptr;
+        }
+
+        std::vector<DFAStateID> blockof;
+        size_t blockcount = 0;
+        DFAMachine::minimize(states.size(), classcount, transitions, accepting, blockof, blockcount);
+
+        //the empty set of NFA states (if it was reached) is the dead state -- all states that cannot reach an accept are merged with it
+        auto deadii = stateids.find(std::vector<StateID>{});
+        const DFAStateID deadblock = (deadii != stateids.end()) ? blockof[deadii->second] : DFA_UNKNOWN_STATE;
+
+        std::vector<bool> blockaccepting(blockcount, false);
+        for(size_t s = 0; s < states.size(); ++s) {
+            blockaccepting[blockof[s]] = accepting[s];
+        }
+
+        //number the blocks as dead, non-accepting, then accepting and scale the ids to row offsets
+        std::vector<DFAStateID> rowof(blockcount, DFA_UNKNOWN_STATE);
+        size_t rowcount = 0;
+        if(deadblock != DFA_UNKNOWN_STATE) {
+            rowof[deadblock] = (DFAStateID)(rowcount++ * classcount);
+        }
+        for(size_t b = 0; b < blockcount; ++b) {
+            if(rowof[b] == DFA_UNKNOWN_STATE && !blockaccepting[b]) {
+                rowof[b] = (DFAStateID)(rowcount++ * classcount);
+            }
+        }
+        const DFAStateID firstaccepting = (DFAStateID)(rowcount * classcount);
+        for(size_t b = 0; b < blockcount; ++b) {
+            if(rowof[b] == DFA_UNKNOWN_STATE) {
+                rowof[b] = (DFAStateID)(rowcount++ * classcount);
+            }
+        }
+
+        std::vector<DFAStateID> mintransitions(blockcount * classcount, DFA_UNKNOWN_STATE);
+        for(size_t s = 0; s < states.size(); ++s) {
+            const DFAStateID row = rowof[blockof[s]];
+            for(size_t c = 0; c < classcount; ++c) {
+                mintransitions[row + c] = rowof[blockof[transitions[(s * classcount) + c]]];
+            }
+        }
+
+        //all states that accept everything are merged by minimization into one accepting state that loops on every class
+        DFAStateID universalstate = DFA_UNKNOWN_STATE;
+        for(DFAStateID row = firstaccepting; row < (DFAStateID)mintransitions.size(); row += (DFAStateID)classcount) {
+            if(std::all_of(mintransitions.cbegin() + row, mintransitions.cbegin() + row + classcount, [row](DFAStateID t) { return t == row; })) {
+                universalstate = row;
+            }
+        }
+
+        const DFAStateID deadstate = (deadblock != DFA_UNKNOWN_STATE) ? rowof[deadblock] : DFA_UNKNOWN_STATE;
+        return new DFAMachine(classes, rowof[blockof[nfastart]], deadstate, firstaccepting, universalstate, mintransitions);
+    }
+}
@@ -0,0 +1,235 @@
+#pragma once
+
+#include "../common.h"
+
+#include "nfa_machine.h"
+#include "charclass_map.h"
+
+namespace brex
+{
+    typedef int32_t DFAStateID;
+
+    //marker for a transition that has not been computed yet
+    #define DFA_UNKNOWN_STATE -1
+
+    //the (always present) state for the empty set of NFA states
+    #define DFA_DEAD_STATE 0
+
+    //memory budget for the cached states + transition table of a single lazy DFA
+    #define LAZY_DFA_CACHE_BYTES (1 << 20)
+
+    //number of times the cache can be flushed in a single search before we decide it is thrashing and give up
+    #define LAZY_DFA_MAX_FLUSHES_PER_SEARCH 4
+
+    //a limit on the number of (unminimized) states when compiling a DFA ahead of time that fits the machines of typical regexes -- callers opt in to AOT compilation by passing it (or their own budget) to the compiler
+    #define DFA_STATE_BUDGET 256
+
+    //the budget used when the caller does not pass one -- 0 so AOT compilation is off unless it is built with -DDFA_DEFAULT_STATE_BUDGET=<states>
+    #ifndef DFA_DEFAULT_STATE_BUDGET
+    #define DFA_DEFAULT_STATE_BUDGET 0
+    #endif
+
+    //limit on the size of the dense transition table of an AOT compiled DFA
+    #define DFA_MAX_TABLE_ENTRIES (1 << 18)
+
+    //ends the states of each machine in the key of a product DFA state
+    #define DFA_PRODUCT_KEY_SEPARATOR UINT32_MAX
+
+    //A DFA that is built on the fly from the sets of (simple) NFA states reached while matching, with a bounded transition cache
+    class LazyDFAMachine
+    {
+    private:
+        const NFAMachine* m;
+
+        //the char classes of m are never modified so they are built once and shared by every copy (and match context) of the machine -- freed with the last one
+        std::shared_ptr<const CharClassMap> classes;
+        size_t maxstates;
+
+        //the sorted NFA states that each DFA state represents and the reverse mapping
+        std::vector<std::vector<StateID>> states;
+        std::vector<bool> accepting;
+        std::vector<bool> universal;
+        std::map<std::vector<StateID>, DFAStateID> stateids;
+
+        //the char that moves a search machine from its start state to its idle state (if it has been marked)
+        bool markedidle;
+        RegexChar idlechar;
+
+        //the NFA states of the idle state of a search machine (once the cache is built) and the DFA states that represent them
+        std::vector<StateID> idlekey;
+        bool hasidle;
+        std::vector<bool> idle;
+
+        //classes->classcount() entries per DFA state
+        std::vector<DFAStateID> transitions;
+
+        DFAStateID startstate;
+
+        size_t searchflushes;
+        bool disabled;
+
+        //scratch space for computing transitions with the NFA
+        NFAState cstates;
+        NFAState nstates;
+        NFAEpsilonWorkSet workset;
+        NFAEpsilonFixpointSet fixpoint;
+        std::vector<StateID> scratchkey;
+
+        DFAStateID addState(const std::vector<StateID>& nfastates);
+        void flushCache();
+
+        //set up the cache (and the idle state) on the first search
+        void buildCache();
+
+        DFAStateID computeTransition(DFAStateID s, RegexChar c, size_t cls);
+
+    public:
+        LazyDFAMachine() : m(nullptr), classes(nullptr), maxstates(0), states(), accepting(), universal(), stateids(), markedidle(false), idlechar(0), idlekey(), hasidle(false), idle(), transitions(), startstate(DFA_DEAD_STATE), searchflushes(0), disabled(true), cstates(), nstates(), workset(), fixpoint(), scratchkey() {;}
+        LazyDFAMachine(const NFAMachine* m, std::shared_ptr<const CharClassMap> classes) : m(m), classes(classes), maxstates(LAZY_DFA_CACHE_BYTES / (classes->classcount() * sizeof(DFAStateID))), states(), accepting(), universal(), stateids(), markedidle(false), idlechar(0), idlekey(), hasidle(false), idle(), transitions(), startstate(DFA_DEAD_STATE), searchflushes(0), disabled(!LazyDFAMachine::canDeterminize(m)), cstates(), nstates(), workset(), fixpoint(), scratchkey() {;}
+        ~LazyDFAMachine() = default;
+
+        LazyDFAMachine(const LazyDFAMachine& other) = default;
+        LazyDFAMachine(LazyDFAMachine&& other) = default;
+
+        LazyDFAMachine& operator=(const LazyDFAMachine& other) = default;
+        LazyDFAMachine& operator=(LazyDFAMachine&& other) = default;
+
+        //true if the machine only uses simple tokens (no RangeK counters) so the sets of NFA states are a finite alphabet
+        static bool canDeterminize(const NFAMachine* m);
+
+        //a machine with the same (shared) char classes and an empty cache
+        LazyDFAMachine createMatchContext() const
+        {
+            return this->m != nullptr ? LazyDFAMachine(this->m, this->classes) : LazyDFAMachine();
+        }
+
+        //false if the machine cannot be determinized or the cache thrashed in an earlier search -- then use the NFA instead
+        inline bool enabled() const
+        {
+            return !this->disabled;
+        }
+
+        //true if the last search gave up part way -- its result is meaningless and it must be rerun on the NFA
+        inline bool gaveup() const
+        {
+            return this->disabled;
+        }
+
+        //number of times the cache has been flushed in the current search
+        inline size_t flushCount() const
+        {
+            return this->searchflushes;
+        }
+
+        //mark the state that the machine moves to from the start state on c (a char that cannot start a match) as idle -- for a search machine this is its leading .* loop
+        void markIdle(RegexChar c);
+
+        //start a new search -- the cache is only built once the machine is used so executors that never run it do not pay for it
+        DFAStateID intitializeMachine()
+        {
+            if(this->states.empty()) {
+                this->buildCache();
+            }
+
+            this->searchflushes = 0;
+            return this->startstate;
+        }
+
+        inline DFAStateID stepMachine(DFAStateID s, RegexChar c)
+        {
+            const size_t cls = this->classes->classOf(c);
+            const DFAStateID ns = this->transitions[(s * this->classes->classcount()) + cls];
+            if(ns != DFA_UNKNOWN_STATE) {
+                return ns;
+            }
+
+            return this->computeTransition(s, c, cls);
+        }
+
+        inline bool inAccepted(DFAStateID s) const
+        {
+            return this->accepting[s];
+        }
+
+        inline bool allRejected(DFAStateID s) const
+        {
+            return s == DFA_DEAD_STATE;
+        }
+
+        inline bool allAccepted(DFAStateID s) const
+        {
+            return this->universal[s];
+        }
+
+        inline bool inIdle(DFAStateID s) const
+        {
+            return this->idle[s];
+        }
+    };
+
+    //A fully determinized and minimized DFA with a dense transition table over the char classes of the machine
+    class DFAMachine
+    {
+    private:
+        static void minimize(size_t statecount, size_t classcount, const std::vector<DFAStateID>& transitions, const std::vector<bool>& accepting, std::vector<DFAStateID>& blockof, size_t& blockcount);
+
+    public:
+        //shared with the other machines of the regex
+        const std::shared_ptr<const CharClassMap> classes;
+        const size_t classcount;
+
+        //states are numbered by the offset of their row in the transition table and ordered as: dead state (if any), other non-accepting states, accepting states
+        const DFAStateID startstate;
+        const DFAStateID deadstate;
+        const DFAStateID firstaccepting;
+
+        //the accepting state that all chars loop back to (if any)
+        const DFAStateID universalstate;
+
+        //classcount entries per state
+        const std::vector<DFAStateID> transitions;
+
+        DFAMachine(std::shared_ptr<const CharClassMap> classes, DFAStateID startstate, DFAStateID deadstate, DFAStateID firstaccepting, DFAStateID universalstate, std::vector<DFAStateID> transitions) : classes(classes), classcount(classes->classcount()), startstate(startstate), deadstate(deadstate), firstaccepting(firstaccepting), universalstate(universalstate), transitions(transitions) {;}
+        ~DFAMachine() = default;
+
+        //build the minimized DFA for a machine or return nullptr if it has counters or needs more than statebudget states
+        static DFAMachine* tryCompile(const NFAMachine* m, size_t statebudget);
+
+        //the same but over the (shared) char classes of the regex -- they must separate the chars that m tests
+        static DFAMachine* tryCompile(const NFAMachine* m, std::shared_ptr<const CharClassMap> classes, size_t statebudget);
+
+        //build the minimized DFA that accepts the strings that every one of the machines accepts (stepping them all in lockstep) -- nullptr if any has counters or it needs more than statebudget states
+        //a machine that is marked as complemented is satisfied by the strings it rejects (for negated checks)
+        static DFAMachine* tryCompileProduct(const std::vector<const NFAMachine*>& ms, const std::vector<bool>& complemented, std::shared_ptr<const CharClassMap> classes, size_t statebudget);
+
+        inline size_t statecount() const
+        {
+            return this->transitions.size() / this->classcount;
+        }
+
+        inline DFAStateID intitializeMachine() const
+        {
+            return this->startstate;
+        }
+
+        inline DFAStateID stepMachine(DFAStateID s, RegexChar c) const
+        {
+            return this->transitions[s + this->classes->classOf(c)];
+        }
+
+        inline bool inAccepted(DFAStateID s) const
+        {
+            return s >= this->firstaccepting;
+        }
+
+        inline bool allRejected(DFAStateID s) const
+        {
+            return s == this->deadstate;
+        }
+
+        inline bool allAccepted(DFAStateID s) const
+        {
+            return s == this->universalstate;
+        }
+    };
+}
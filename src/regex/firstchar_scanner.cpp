@@ -0,0 +1,112 @@
+#include "firstchar_scanner.h"
+
+namespace brex
+{
+    //the first byte of the utf8 encoding of c -- this is monotone in c so a range of chars has a range of lead bytes
+    static uint8_t leadByteOf(RegexChar c)
+    {
+        if(c < 0x80) {
+            return (uint8_t)c;
+        }
+        else if(c < 0x800) {
+            return (uint8_t)(0xC0 | (c >> 6));
+        }
+        else if(c < 0x10000) {
+            return (uint8_t)(0xE0 | (c >> 12));
+        }
+        else {
+            return (uint8_t)(0xF0 | std::min<RegexChar>(c >> 18, 0x7));
+        }
+    }
+
+    static void addByteRange(std::array<uint64_t, 4>& bytemask, RegexChar low, RegexChar high, bool isunicode)
+    {
+        const uint32_t lb = isunicode ? leadByteOf(low) : (uint32_t)std::min<RegexChar>(low, 255);
+        const uint32_t hb = isunicode ? leadByteOf(high) : (uint32_t)std::min<RegexChar>(high, 255);
+        for(uint32_t b = lb; b <= hb; ++b) {
+            bytemask[b / 64] |= ((uint64_t)1 << (b % 64));
+        }
+    }
+
+    FirstCharScanner::FirstCharScanner(std::array<uint64_t, 4> bytemask) : bytemask(bytemask), bytecount(0), idlechar(0), lowtable(), hightable()
+    {
+        for(uint32_t b = 0; b < 256; ++b) {
+            if(this->test((uint8_t)b)) {
+                this->bytecount++;
+
+                std::array<uint8_t, 16>& table = (b < 128) ? this->lowtable : this->hightable;
+                table[b & 0x0F] |= (uint8_t)(1 << ((b >> 4) % 8));
+            }
+        }
+
+        //any char that is not in the set drives a search machine to its idle state -- pick an ascii one so it is a single byte in both string types
+        auto idle = std::find_if(this->bytemask.cbegin(), this->bytemask.cbegin() + 2, [](uint64_t w) { return w != UINT64_MAX; });
+        if(idle == this->bytemask.cbegin() + 2) {
+            this->bytecount = 0;
+        }
+        else {
+            this->idlechar = (RegexChar)(((idle - this->bytemask.cbegin()) * 64) + __builtin_ctzll(~*idle));
+        }
+    }
+
+    FirstCharScanner FirstCharScanner::build(const NFAMachine* m, bool isunicode)
+    {
+        const NFAProgram& program = m->program;
+
+        std::array<uint64_t, 4> bytemask = { 0, 0, 0, 0 };
+        std::vector<bool> visited(program.size(), false);
+        std::vector<StateID> pending = { m->startstate };
+        while(!pending.empty()) {
+            const StateID s = pending.back();
+            pending.pop_back();
+
+            if(visited[s]) {
+                continue;
+            }
+            visited[s] = true;
+
+            switch(program.tags[s]) {
+                case NFAOptTag::Accept:
+                case NFAOptTag::Dot: {
+                    //the empty string (or any char) can start a match so every position is a candidate
+                    return FirstCharScanner();
+                }
+                case NFAOptTag::CharCode: {
+                    addByteRange(bytemask, program.operands[s], program.operands[s], isunicode);
+                    break;
+                }
+                case NFAOptTag::CharRange: {
+                    const NFAProgramRangeSet& rset = program.rangesets[program.operands[s]];
+                    for(uint32_t i = 0; i < rset.count; ++i) {
+                        const SingleCharRange& rr = program.ranges[rset.start + i];
+                        addByteRange(bytemask, rr.low, rr.high, isunicode);
+                    }
+                    break;
+                }
+                case NFAOptTag::AnyOf: {
+                    std::copy(program.anyofFollowsBegin(s), program.anyofFollowsEnd(s), std::back_inserter(pending));
+                    break;
+                }
+                case NFAOptTag::Star: {
+                    pending.push_back(program.follows[s]);
+                    pending.push_back(program.starSkipFollow(s));
+                    break;
+                }
+                default: {
+                    //a RangeK may be entered or skipped (when its low bound is 0)
+                    pending.push_back(program.follows[s]);
+                    pending.push_back(program.counter(s).outfollow);
+                    break;
+                }
+            }
+        }
+
+        if(isunicode) {
+            //a range of lead bytes can span continuation bytes (0x80-0xBF) and bytes that never start a char (0xC0, 0xC1, 0xF5-0xFF) -- a skip must land on a char start
+            bytemask[2] = 0;
+            bytemask[3] &= ~(uint64_t)0x3 & (((uint64_t)1 << (0xF5 - 0xC0)) - 1);
+        }
+
+        return FirstCharScanner(bytemask);
+    }
+}
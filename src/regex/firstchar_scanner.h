@@ -0,0 +1,96 @@
+#pragma once
+
+#include "../common.h"
+
+#include <array>
+
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
+
+#include "nfa_machine.h"
+
+namespace brex
+{
+    //Finds the positions in the input that can start a match -- the (lead) bytes of the chars that the forward machine can take its first step on
+    //A search machine that is idle in its leading .* stays there on any other byte so unanchored searches jump straight to the next candidate (with an AVX2 byte class kernel when it is available)
+    class FirstCharScanner
+    {
+    public:
+        //bit b is set if byte b can be the first byte of a match
+        std::array<uint64_t, 4> bytemask;
+        size_t bytecount;
+
+        //an ascii char that cannot start a match (only meaningful if the scanner is enabled)
+        RegexChar idlechar;
+
+        //the low nibble tables for bytes with the high nibble in 0-7 and in 8-15 -- entry l has bit (h % 8) set if byte (h << 4) | l is in the set
+        std::array<uint8_t, 16> lowtable;
+        std::array<uint8_t, 16> hightable;
+
+        FirstCharScanner() : bytemask(), bytecount(0), idlechar(0), lowtable(), hightable() {;}
+        FirstCharScanner(std::array<uint64_t, 4> bytemask);
+        ~FirstCharScanner() = default;
+
+        FirstCharScanner(const FirstCharScanner& other) = default;
+        FirstCharScanner(FirstCharScanner&& other) = default;
+
+        FirstCharScanner& operator=(const FirstCharScanner& other) = default;
+        FirstCharScanner& operator=(FirstCharScanner&& other) = default;
+
+        //the scanner for the first chars of the (forward) machine -- disabled if the machine accepts the empty string or can start with (almost) any char
+        static FirstCharScanner build(const NFAMachine* m, bool isunicode);
+
+        inline bool enabled() const
+        {
+            return this->bytecount != 0;
+        }
+
+        inline bool test(uint8_t b) const
+        {
+            return ((this->bytemask[b / 64] >> (b % 64)) & 1) != 0;
+        }
+
+        //the first position in [from, epos] that holds a candidate byte (or epos + 1 if there is none)
+        template <typename TStr>
+        int64_t next(const TStr* sstr, int64_t from, int64_t epos) const
+        {
+            const uint8_t* data = reinterpret_cast<const uint8_t*>(sstr->data());
+
+            //the common case in dense input is that we are already at a candidate so check it before setting up the vector loop
+            if(from > epos || this->test(data[from])) {
+                return from;
+            }
+
+            int64_t pos = from + 1;
+#ifdef __AVX2__
+            const __m256i lows = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(this->lowtable.data())));
+            const __m256i highs = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(this->hightable.data())));
+            const __m256i bits = _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+            const __m256i nibble = _mm256_set1_epi8(0x0F);
+            const __m256i zero = _mm256_setzero_si256();
+
+            while(pos + 32 <= epos + 1) {
+                const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + pos));
+                const __m256i lo = _mm256_and_si256(v, nibble);
+                const __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), nibble);
+
+                //the sign bit of the byte picks the table for its high nibble and the high nibble picks the bit in the entry
+                const __m256i row = _mm256_blendv_epi8(_mm256_shuffle_epi8(lows, lo), _mm256_shuffle_epi8(highs, lo), v);
+                const __m256i hits = _mm256_and_si256(row, _mm256_shuffle_epi8(bits, hi));
+
+                const uint32_t mask = ~(uint32_t)_mm256_movemask_epi8(_mm256_cmpeq_epi8(hits, zero));
+                if(mask != 0) {
+                    return pos + (int64_t)__builtin_ctz(mask);
+                }
+                pos += 32;
+            }
+#endif
+
+            while(pos <= epos && !this->test(data[pos])) {
+                pos++;
+            }
+            return pos;
+        }
+    };
+}
@@ -0,0 +1,245 @@
+#include "literal_prefilter.h"
+
+#include "brex.h"
+
+namespace brex
+{
+    //the literal factors of a regex (sub)term -- every string the term accepts starts with prefix, ends with suffix, and contains inner
+    //if exact is set the term only accepts the string in prefix (and suffix and inner are the same string)
+    class LiteralTermInfo
+    {
+    public:
+        bool exact;
+        std::vector<RegexChar> prefix;
+        std::vector<RegexChar> suffix;
+        std::vector<RegexChar> inner;
+
+        //max number of chars in a string the term accepts (-1 if unbounded)
+        int64_t maxchars;
+
+        LiteralTermInfo() : exact(true), prefix(), suffix(), inner(), maxchars(0) {;}
+        LiteralTermInfo(bool exact, std::vector<RegexChar> prefix, std::vector<RegexChar> suffix, std::vector<RegexChar> inner, int64_t maxchars) : exact(exact), prefix(prefix), suffix(suffix), inner(inner), maxchars(maxchars) {;}
+        ~LiteralTermInfo() = default;
+
+        LiteralTermInfo(const LiteralTermInfo& other) = default;
+        LiteralTermInfo(LiteralTermInfo&& other) = default;
+
+        LiteralTermInfo& operator=(const LiteralTermInfo& other) = default;
+        LiteralTermInfo& operator=(LiteralTermInfo&& other) = default;
+
+        static LiteralTermInfo makeExact(const std::vector<RegexChar>& codes, int64_t maxchars)
+        {
+            return LiteralTermInfo(true, codes, codes, codes, maxchars).limit();
+        }
+
+        static LiteralTermInfo makeNone(int64_t maxchars)
+        {
+            return LiteralTermInfo(false, {}, {}, {}, maxchars);
+        }
+
+        //cut the factors down to REQUIRED_LITERAL_MAX_LENGTH chars (any part of a required factor is still required)
+        LiteralTermInfo limit() const
+        {
+            LiteralTermInfo res = *this;
+            if(res.prefix.size() > REQUIRED_LITERAL_MAX_LENGTH) {
+                res.exact = false;
+                res.prefix.resize(REQUIRED_LITERAL_MAX_LENGTH);
+            }
+            if(res.suffix.size() > REQUIRED_LITERAL_MAX_LENGTH) {
+                res.exact = false;
+                res.suffix.erase(res.suffix.begin(), res.suffix.end() - REQUIRED_LITERAL_MAX_LENGTH);
+            }
+            if(res.inner.size() > REQUIRED_LITERAL_MAX_LENGTH) {
+                res.exact = false;
+                res.inner.resize(REQUIRED_LITERAL_MAX_LENGTH);
+            }
+
+            return res;
+        }
+
+        const std::vector<RegexChar>& best() const
+        {
+            const std::vector<RegexChar>& fix = (this->prefix.size() >= this->suffix.size()) ? this->prefix : this->suffix;
+            return (fix.size() >= this->inner.size()) ? fix : this->inner;
+        }
+    };
+
+    class LiteralTermBuilder
+    {
+    private:
+        static std::vector<RegexChar> append(const std::vector<RegexChar>& c1, const std::vector<RegexChar>& c2)
+        {
+            std::vector<RegexChar> res = c1;
+            std::copy(c2.cbegin(), c2.cend(), std::back_inserter(res));
+
+            return res;
+        }
+
+        static const std::vector<RegexChar>& longest(const std::vector<RegexChar>& c1, const std::vector<RegexChar>& c2)
+        {
+            return (c1.size() >= c2.size()) ? c1 : c2;
+        }
+
+        static int64_t addMax(int64_t m1, int64_t m2)
+        {
+            return (m1 < 0 || m2 < 0 || m1 + m2 > INT32_MAX) ? -1 : m1 + m2;
+        }
+
+        static int64_t mulMax(int64_t m, int64_t k)
+        {
+            return (m < 0 || (m != 0 && k > INT32_MAX / m)) ? -1 : m * k;
+        }
+
+        static LiteralTermInfo concat(const LiteralTermInfo& t1, const LiteralTermInfo& t2)
+        {
+            const int64_t maxchars = LiteralTermBuilder::addMax(t1.maxchars, t2.maxchars);
+            if(t1.exact && t2.exact) {
+                return LiteralTermInfo::makeExact(LiteralTermBuilder::append(t1.prefix, t2.prefix), maxchars);
+            }
+
+            auto prefix = t1.exact ? LiteralTermBuilder::append(t1.prefix, t2.prefix) : t1.prefix;
+            auto suffix = t2.exact ? LiteralTermBuilder::append(t1.suffix, t2.suffix) : t2.suffix;
+            auto span = LiteralTermBuilder::append(t1.suffix, t2.prefix);
+            auto inner = LiteralTermBuilder::longest(LiteralTermBuilder::longest(t1.inner, t2.inner), span);
+
+            return LiteralTermInfo(false, prefix, suffix, inner, maxchars).limit();
+        }
+
+        //the term repeated at least low times -- so the factors of the term (but not its exactness) carry over
+        static LiteralTermInfo repeatAtLeast(const LiteralTermInfo& t, uint16_t low, int64_t maxchars)
+        {
+            if(low == 0) {
+                return LiteralTermInfo::makeNone(maxchars);
+            }
+
+            if(!t.exact) {
+                return LiteralTermInfo(false, t.prefix, t.suffix, t.inner, maxchars);
+            }
+
+            //an exact term repeated low times is a required factor on its own
+            LiteralTermInfo rep;
+            for(uint16_t i = 0; i < low && rep.prefix.size() <= REQUIRED_LITERAL_MAX_LENGTH; ++i) {
+                rep = LiteralTermBuilder::concat(rep, t);
+            }
+            return LiteralTermInfo(false, rep.prefix, rep.suffix, rep.inner, maxchars).limit();
+        }
+
+        static LiteralTermInfo buildCharRange(const CharRangeOpt* opt)
+        {
+            if(!opt->compliment && opt->ranges.size() == 1 && opt->ranges[0].low == opt->ranges[0].high) {
+                return LiteralTermInfo::makeExact({ opt->ranges[0].low }, 1);
+            }
+
+            return LiteralTermInfo::makeNone(1);
+        }
+
+        static LiteralTermInfo buildRangeRepeat(const RangeRepeatOpt* opt)
+        {
+            auto t = LiteralTermBuilder::build(opt->repeat);
+            const int64_t maxchars = (opt->high == UINT16_MAX) ? (t.maxchars == 0 ? 0 : -1) : LiteralTermBuilder::mulMax(t.maxchars, opt->high);
+
+            if(t.exact && opt->low == opt->high) {
+                LiteralTermInfo rep;
+                for(uint16_t i = 0; i < opt->low; ++i) {
+                    rep = LiteralTermBuilder::concat(rep, t);
+                    if(!rep.exact) {
+                        return LiteralTermBuilder::repeatAtLeast(t, opt->low, maxchars);
+                    }
+                }
+                return rep;
+            }
+
+            return LiteralTermBuilder::repeatAtLeast(t, opt->low, maxchars);
+        }
+
+        static LiteralTermInfo buildAnyOf(const AnyOfOpt* opt)
+        {
+            std::vector<LiteralTermInfo> terms;
+            std::transform(opt->opts.cbegin(), opt->opts.cend(), std::back_inserter(terms), [](const RegexOpt* o) { return LiteralTermBuilder::build(o); });
+            if(terms.empty()) {
+                return LiteralTermInfo::makeNone(0);
+            }
+
+            int64_t maxchars = 0;
+            for(auto iter = terms.cbegin(); iter != terms.cend(); ++iter) {
+                maxchars = (maxchars < 0 || iter->maxchars < 0) ? -1 : std::max(maxchars, iter->maxchars);
+            }
+
+            const bool allsame = std::all_of(terms.cbegin(), terms.cend(), [&terms](const LiteralTermInfo& t) { return t.exact && t.prefix == terms.front().prefix; });
+            if(allsame) {
+                return LiteralTermInfo::makeExact(terms.front().prefix, maxchars);
+            }
+
+            //the common prefix/suffix of the options are required (the inner factors of the options need not be)
+            std::vector<RegexChar> prefix = terms.front().prefix;
+            std::vector<RegexChar> suffix = terms.front().suffix;
+            for(auto iter = terms.cbegin() + 1; iter != terms.cend(); ++iter) {
+                auto pmm = std::mismatch(prefix.cbegin(), prefix.cend(), iter->prefix.cbegin(), iter->prefix.cend());
+                prefix.erase(pmm.first, prefix.cend());
+
+                auto smm = std::mismatch(suffix.crbegin(), suffix.crend(), iter->suffix.crbegin(), iter->suffix.crend());
+                suffix.erase(suffix.cbegin(), smm.first.base());
+            }
+
+            return LiteralTermInfo(false, prefix, suffix, {}, maxchars);
+        }
+
+        static LiteralTermInfo buildSequence(const SequenceOpt* opt)
+        {
+            LiteralTermInfo res;
+            for(auto iter = opt->regexs.cbegin(); iter != opt->regexs.cend(); ++iter) {
+                res = LiteralTermBuilder::concat(res, LiteralTermBuilder::build(*iter));
+            }
+
+            return res;
+        }
+
+    public:
+        static LiteralTermInfo build(const RegexOpt* opt)
+        {
+            switch(opt->tag) {
+                case RegexOptTag::Literal: {
+                    const LiteralOpt* lit = static_cast<const LiteralOpt*>(opt);
+                    return LiteralTermInfo::makeExact(lit->codes, (int64_t)lit->codes.size());
+                }
+                case RegexOptTag::CharRange: {
+                    return LiteralTermBuilder::buildCharRange(static_cast<const CharRangeOpt*>(opt));
+                }
+                case RegexOptTag::CharClassDot: {
+                    return LiteralTermInfo::makeNone(1);
+                }
+                case RegexOptTag::StarRepeat: {
+                    auto t = LiteralTermBuilder::build(static_cast<const StarRepeatOpt*>(opt)->repeat);
+                    return LiteralTermInfo::makeNone(t.maxchars == 0 ? 0 : -1);
+                }
+                case RegexOptTag::PlusRepeat: {
+                    auto t = LiteralTermBuilder::build(static_cast<const PlusRepeatOpt*>(opt)->repeat);
+                    return LiteralTermBuilder::repeatAtLeast(t, 1, t.maxchars == 0 ? 0 : -1);
+                }
+                case RegexOptTag::RangeRepeat: {
+                    return LiteralTermBuilder::buildRangeRepeat(static_cast<const RangeRepeatOpt*>(opt));
+                }
+                case RegexOptTag::Optional: {
+                    auto t = LiteralTermBuilder::build(static_cast<const OptionalOpt*>(opt)->opt);
+                    return LiteralTermInfo::makeNone(t.maxchars);
+                }
+                case RegexOptTag::AnyOf: {
+                    return LiteralTermBuilder::buildAnyOf(static_cast<const AnyOfOpt*>(opt));
+                }
+                case RegexOptTag::Sequence: {
+                    return LiteralTermBuilder::buildSequence(static_cast<const SequenceOpt*>(opt));
+                }
+                default: {
+                    //named/env regexes are resolved before this runs -- so be conservative if one is left
+                    return LiteralTermInfo::makeNone(-1);
+                }
+            }
+        }
+    };
+
+    RequiredLiteral RequiredLiteral::extract(const RegexOpt* opt)
+    {
+        auto t = LiteralTermBuilder::build(opt);
+        return RequiredLiteral(t.best(), t.maxchars);
+    }
+}
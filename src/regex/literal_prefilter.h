@@ -0,0 +1,178 @@
+#pragma once
+
+#include "../common.h"
+
+#include <string.h>
+#include <algorithm>
+#include <type_traits>
+
+namespace brex
+{
+    class RegexOpt;
+
+    //max number of chars in a required literal (longer factors are cut down to this)
+    #define REQUIRED_LITERAL_MAX_LENGTH 64
+
+    //A literal that every match of a regex contains and the max number of chars in a match (-1 if unbounded)
+    class RequiredLiteral
+    {
+    public:
+        std::vector<RegexChar> codes;
+        int64_t maxchars;
+
+        RequiredLiteral() : codes(), maxchars(-1) {;}
+        RequiredLiteral(std::vector<RegexChar> codes, int64_t maxchars) : codes(codes), maxchars(maxchars) {;}
+        ~RequiredLiteral() = default;
+
+        RequiredLiteral(const RequiredLiteral& other) = default;
+        RequiredLiteral(RequiredLiteral&& other) = default;
+
+        RequiredLiteral& operator=(const RequiredLiteral& other) = default;
+        RequiredLiteral& operator=(RequiredLiteral&& other) = default;
+
+        //the longest literal factor (prefix, suffix, or inner) that every string the (resolved) regex accepts contains -- empty codes if there is none
+        static RequiredLiteral extract(const RegexOpt* opt);
+    };
+
+    //Skips the parts of the input that cannot contain a match by scanning for the required literal with memmem (and only running the machines in windows around the hits)
+    //A match contains an occurrence of the literal so it is inside the maxchars window around that occurrence -- overlapping windows are merged so every match is inside exactly one window
+    template <typename TStr>
+    class LiteralPrefilter
+    {
+    public:
+        //the encoded bytes of the literal (empty if there is no prefilter)
+        TStr literal;
+        int64_t literalchars;
+        int64_t maxchars;
+
+        LiteralPrefilter() : literal(), literalchars(0), maxchars(-1) {;}
+        LiteralPrefilter(TStr literal, int64_t literalchars, int64_t maxchars) : literal(literal), literalchars(literalchars), maxchars(maxchars) {;}
+        ~LiteralPrefilter() = default;
+
+        LiteralPrefilter(const LiteralPrefilter& other) = default;
+        LiteralPrefilter(LiteralPrefilter&& other) = default;
+
+        LiteralPrefilter& operator=(const LiteralPrefilter& other) = default;
+        LiteralPrefilter& operator=(LiteralPrefilter&& other) = default;
+
+        static LiteralPrefilter<TStr> build(const RegexOpt* opt)
+        {
+            auto rl = RequiredLiteral::extract(opt);
+
+            TStr literal;
+            for(auto iter = rl.codes.cbegin(); iter != rl.codes.cend(); ++iter) {
+                if constexpr(std::is_same_v<TStr, UnicodeString>) {
+                    auto bytes = extractRegexCharToBytes(*iter);
+                    std::transform(bytes.cbegin(), bytes.cend(), std::back_inserter(literal), [](uint8_t b) { return (UnicodeStringChar)b; });
+                }
+                else {
+                    literal.push_back((CStringChar)*iter);
+                }
+            }
+
+            return LiteralPrefilter<TStr>(literal, (int64_t)rl.codes.size(), rl.maxchars);
+        }
+
+        inline bool enabled() const
+        {
+            return !this->literal.empty();
+        }
+
+        //the position of the next occurrence of the literal in [from, epos] (or -1 if there is none)
+        int64_t find(const TStr* sstr, int64_t from, int64_t epos) const
+        {
+            if(epos - from + 1 < (int64_t)this->literal.size()) {
+                return -1;
+            }
+
+            const char* base = reinterpret_cast<const char*>(sstr->data());
+            const void* hit = memmem(base + from, (size_t)(epos - from + 1), this->literal.data(), this->literal.size());
+            return hit != nullptr ? (int64_t)(static_cast<const char*>(hit) - base) : -1;
+        }
+
+        //move pos back by count chars (but not before spos)
+        int64_t backChars(const TStr* sstr, int64_t pos, int64_t count, int64_t spos) const
+        {
+            if constexpr(std::is_same_v<TStr, UnicodeString>) {
+                for(int64_t i = 0; i < count && pos > spos; ++i) {
+                    pos--;
+                    while(pos > spos && UTF8_IS_CONTINUATION_BYTE((*sstr)[pos])) {
+                        pos--;
+                    }
+                }
+                return pos;
+            }
+            else {
+                return std::max(spos, pos - count);
+            }
+        }
+
+        //move pos (the start of a char) forward by count chars (but not after epos + 1)
+        int64_t forwardChars(const TStr* sstr, int64_t pos, int64_t count, int64_t epos) const
+        {
+            if constexpr(std::is_same_v<TStr, UnicodeString>) {
+                for(int64_t i = 0; i < count && pos <= epos; ++i) {
+                    pos += UTF8_IS_SINGLEBYTE_ENCODING((*sstr)[pos]) ? 1 : (int64_t)charCodeByteCount(reinterpret_cast<const uint8_t*>(sstr->data()) + pos);
+                }
+                return std::min(pos, epos + 1);
+            }
+            else {
+                return std::min(epos + 1, pos + count);
+            }
+        }
+
+        //the last byte of the char that pos is in (epos can be any byte of the last char in a range)
+        int64_t charEnd(const TStr* sstr, int64_t pos) const
+        {
+            if constexpr(std::is_same_v<TStr, UnicodeString>) {
+                if(pos < 0 || pos >= (int64_t)sstr->size()) {
+                    return pos;
+                }
+
+                while(pos > 0 && UTF8_IS_CONTINUATION_BYTE((*sstr)[pos])) {
+                    pos--;
+                }
+                return this->forwardChars(sstr, pos, 1, (int64_t)sstr->size() - 1) - 1;
+            }
+            else {
+                return pos;
+            }
+        }
+
+        //the next window [wspos, wepos] in [spos, epos] that holds the matches around the occurrences of the literal at or after from -- false if there are no more occurrences
+        //on success from is updated to continue the scan after the window
+        bool nextWindow(const TStr* sstr, int64_t& from, int64_t spos, int64_t epos, int64_t& wspos, int64_t& wepos) const
+        {
+            epos = this->charEnd(sstr, epos);
+
+            int64_t hit = this->find(sstr, from, epos);
+            if(hit == -1) {
+                return false;
+            }
+
+            //an unbounded match can reach anywhere so the only thing the literal tells us is that there may be a match
+            if(this->maxchars < 0) {
+                wspos = spos;
+                wepos = epos;
+                from = epos + 1;
+                return true;
+            }
+
+            const int64_t extra = std::max<int64_t>(0, this->maxchars - this->literalchars);
+            wspos = this->backChars(sstr, hit, extra, spos);
+            wepos = this->forwardChars(sstr, hit + (int64_t)this->literal.size(), extra, epos) - 1;
+
+            //merge the windows of the following hits that overlap this one
+            while(true) {
+                hit = this->find(sstr, hit + 1, epos);
+                if(hit == -1 || (hit > wepos && this->backChars(sstr, hit, extra, spos) > wepos)) {
+                    break;
+                }
+                wepos = this->forwardChars(sstr, hit + (int64_t)this->literal.size(), extra, epos) - 1;
+            }
+
+            from = (hit == -1) ? epos + 1 : hit;
+            return true;
+        }
+    };
+}
@@ -3,127 +3,1165 @@
 #include "../common.h"
 
 #include "nfa_machine.h"
+#include "dfa_machine.h"
+#include "bitparallel_machine.h"
+#include "literal_prefilter.h"
+#include "firstchar_scanner.h"
 
 namespace brex
 {
+    //the machine representation that an executor runs a search on
+    enum class ExecutorEngine
+    {
+        NFA,
+        LazyDFA,
+        DFA,
+        BitParallel64,
+        BitParallel128,
+        BitParallel256
+    };
+
+    //the machines a search runs on -- the search machines are the forward/reverse machines behind a leading .* so every step re-enters the start state (for unanchored searches)
+    enum class ExecutorDirection
+    {
+        Forward,
+        Reverse,
+        ForwardSearch,
+        ReverseSearch
+    };
+
+    template <ExecutorEngine E>
+    using ExecutorEngineTag = std::integral_constant<ExecutorEngine, E>;
+
+    template <ExecutorEngine E>
+    constexpr bool isBitParallelEngine()
+    {
+        return E == ExecutorEngine::BitParallel64 || E == ExecutorEngine::BitParallel128 || E == ExecutorEngine::BitParallel256;
+    }
+
+    //number of words in the state of a bit-parallel engine
+    template <ExecutorEngine E>
+    constexpr size_t bitParallelEngineWords()
+    {
+        return E == ExecutorEngine::BitParallel64 ? 1 : (E == ExecutorEngine::BitParallel128 ? 2 : 4);
+    }
+
+    //the boundaries (byte offsets) that a leftmost search can start and end a match at -- marked (from spos) by the anchors around a regex and a missing set of marks allows every boundary
+    class SpanBounds
+    {
+    public:
+        int64_t spos;
+        const std::vector<bool>* starts;
+        const std::vector<bool>* ends;
+
+        SpanBounds() : spos(0), starts(nullptr), ends(nullptr) {;}
+        SpanBounds(int64_t spos, const std::vector<bool>* starts, const std::vector<bool>* ends) : spos(spos), starts(starts), ends(ends) {;}
+        ~SpanBounds() = default;
+
+        SpanBounds(const SpanBounds& other) = default;
+        SpanBounds(SpanBounds&& other) = default;
+
+        SpanBounds& operator=(const SpanBounds& other) = default;
+        SpanBounds& operator=(SpanBounds&& other) = default;
+
+        inline bool canStart(int64_t b) const
+        {
+            return this->starts == nullptr || (*this->starts)[b - this->spos];
+        }
+
+        inline bool canEnd(int64_t b) const
+        {
+            return this->ends == nullptr || (*this->ends)[b - this->spos];
+        }
+    };
+
+    //The compiled machines (and prefilter/scanner) are never modified once built and are shared by every copy of an executor -- all of the per search state below them is owned by the executor
     template <typename TStr, typename TIter>
     class NFAExecutor
     {
     private:
-        NFAMachine* forward; 
-        NFAMachine* reverse;
+        const NFAMachine* forward; 
+        const NFAMachine* reverse;
+
+        //nullptr if the regex is never used for unanchored searches
+        const NFAMachine* forwardsearch;
+        const NFAMachine* reversesearch;
+
+        //ahead of time compiled DFAs (nullptr if the machine could not be compiled within the state budget)
+        const DFAMachine* dfaforward;
+        const DFAMachine* dfareverse;
+        const DFAMachine* dfaforwardsearch;
+        const DFAMachine* dfareversesearch;
+
+        //bit-parallel machines (nullptr if there are too many positions or there is an AOT DFA)
+        const BitParallelMachine* bpforward;
+        const BitParallelMachine* bpreverse;
+        const BitParallelMachine* bpforwardsearch;
+        const BitParallelMachine* bpreversesearch;
 
         TIter iter;
 
-        NFAMachine* m;
+        const NFAMachine* m;
+
+        //double buffered states -- each step reads cstates, writes nstates, and then swaps them
         NFAState cstates;
+        NFAState nstates;
+
+        NFAEpsilonWorkSet workset;
+        NFAEpsilonFixpointSet fixpoint;
+
+        //scan for a literal that every match contains so unanchored searches only run around its occurrences (disabled if there is no such literal)
+        LiteralPrefilter<TStr> prefilter;
+
+        //jump over bytes that cannot start a match while the forward search machine is idle in its leading .* (disabled if most bytes can start a match)
+        FirstCharScanner scanner;
+        bool skipidle;
+
+        //the idle states of the forward search machine for the AOT DFA and bit-parallel engines
+        DFAStateID dfaidle;
+        BitParallelState bpidle;
+
+        //double buffered states for leftmost searches
+        NFATaggedState tcstates;
+        NFATaggedState tnstates;
+
+        //double buffered states (and their start tags) of the groups for leftmost searches on machines with counters -- and the tokens of the higher priority groups in a step
+        std::vector<NFAState> gcstates;
+        std::vector<NFAState> gnstates;
+        std::vector<int64_t> gctags;
+        std::vector<int64_t> gntags;
+        NFAState gcovered;
+
+        //lazy DFAs for the machines (when they can be determinized)
+        LazyDFAMachine lazyforward;
+        LazyDFAMachine lazyreverse;
+        LazyDFAMachine lazyforwardsearch;
+        LazyDFAMachine lazyreversesearch;
+
+        //the DFA in use for the current search and its state
+        const DFAMachine* dfa;
+        LazyDFAMachine* lazydfa;
+        DFAStateID dstate;
+
+        //the bit-parallel machine in use for the current search and its state
+        const BitParallelMachine* bp;
+        BitParallelState bstate;
+
+        void selectMachines(ExecutorDirection dir)
+        {
+            this->skipidle = (dir == ExecutorDirection::ForwardSearch) && this->scanner.enabled();
+            switch(dir) {
+                case ExecutorDirection::Forward: {
+                    this->m = this->forward;
+                    this->dfa = this->dfaforward;
+                    this->bp = this->bpforward;
+                    this->lazydfa = &this->lazyforward;
+                    break;
+                }
+                case ExecutorDirection::Reverse: {
+                    this->m = this->reverse;
+                    this->dfa = this->dfareverse;
+                    this->bp = this->bpreverse;
+                    this->lazydfa = &this->lazyreverse;
+                    break;
+                }
+                case ExecutorDirection::ForwardSearch: {
+                    this->m = this->forwardsearch;
+                    this->dfa = this->dfaforwardsearch;
+                    this->bp = this->bpforwardsearch;
+                    this->lazydfa = &this->lazyforwardsearch;
+                    break;
+                }
+                default: {
+                    this->m = this->reversesearch;
+                    this->dfa = this->dfareversesearch;
+                    this->bp = this->bpreversesearch;
+                    this->lazydfa = &this->lazyreversesearch;
+                    break;
+                }
+            }
+        }
+
+        //run op on the best engine for the direction -- AOT DFA, then bit-parallel, then lazy DFA (rerunning on the NFA if it gives up), then NFA
+        template <typename TOp>
+        auto runOnEngine(ExecutorDirection dir, TOp op) -> decltype(op(ExecutorEngineTag<ExecutorEngine::NFA>{}))
+        {
+            this->selectMachines(dir);
+
+            if(this->dfa != nullptr) {
+                return op(ExecutorEngineTag<ExecutorEngine::DFA>{});
+            }
+
+            if(this->bp != nullptr) {
+                if(this->bp->wordcount == 1) {
+                    return op(ExecutorEngineTag<ExecutorEngine::BitParallel64>{});
+                }
+                else if(this->bp->wordcount == 2) {
+                    return op(ExecutorEngineTag<ExecutorEngine::BitParallel128>{});
+                }
+                else {
+                    return op(ExecutorEngineTag<ExecutorEngine::BitParallel256>{});
+                }
+            }
+
+            if(this->lazydfa->enabled()) {
+                auto res = op(ExecutorEngineTag<ExecutorEngine::LazyDFA>{});
+                if(!this->lazydfa->gaveup()) {
+                    return res;
+                }
+            }
+
+            return op(ExecutorEngineTag<ExecutorEngine::NFA>{});
+        }
 
+        template <ExecutorEngine E>
         void runIntialStep()
         {
-            this->m->intitializeMachine(this->cstates);
+            if constexpr(E == ExecutorEngine::DFA) {
+                this->dstate = this->dfa->intitializeMachine();
+            }
+            else if constexpr(isBitParallelEngine<E>()) {
+                this->bp->template intitializeMachine<bitParallelEngineWords<E>()>(this->bstate);
+            }
+            else if constexpr(E == ExecutorEngine::LazyDFA) {
+                this->dstate = this->lazydfa->intitializeMachine();
+            }
+            else {
+                this->m->intitializeMachine(this->cstates, this->workset, this->fixpoint);
+            }
         }
 
+        template <ExecutorEngine E>
         void runStep(RegexChar c)
         {
-            this->cstates = this->m->stepMachine(c, this->cstates);
+            if constexpr(E == ExecutorEngine::DFA) {
+                this->dstate = this->dfa->stepMachine(this->dstate, c);
+            }
+            else if constexpr(isBitParallelEngine<E>()) {
+                this->bp->template stepMachine<bitParallelEngineWords<E>()>(this->bstate, c);
+            }
+            else if constexpr(E == ExecutorEngine::LazyDFA) {
+                this->dstate = this->lazydfa->stepMachine(this->dstate, c);
+            }
+            else {
+                this->m->stepMachine(c, this->cstates, this->nstates, this->workset, this->fixpoint);
+                this->cstates.swap(this->nstates);
+            }
         }
 
-        inline bool accepted() const { return this->m->inAccepted(this->cstates); }
-        inline bool rejected() const { return this->m->allRejected(this->cstates); }
+        template <ExecutorEngine E>
+        inline bool accepted() const 
+        { 
+            if constexpr(E == ExecutorEngine::DFA) {
+                return this->dfa->inAccepted(this->dstate);
+            }
+            else if constexpr(isBitParallelEngine<E>()) {
+                return this->bp->template inAccepted<bitParallelEngineWords<E>()>(this->bstate);
+            }
+            else if constexpr(E == ExecutorEngine::LazyDFA) {
+                return this->lazydfa->inAccepted(this->dstate);
+            }
+            else {
+                return this->m->inAccepted(this->cstates);
+            }
+        }
 
-    public:
-        NFAExecutor(): forward(nullptr), reverse(nullptr), TIter(), m(nullptr), cstates() {;}
-        NFAExecutor(NFAMachine* forward, NFAMachine* reverse) : forward(forward), reverse(reverse), iter(), m(nullptr), cstates() {;}
-        ~NFAExecutor() = default;
+        template <ExecutorEngine E>
+        inline bool rejected() const 
+        { 
+            if constexpr(E == ExecutorEngine::DFA) {
+                return this->dfa->allRejected(this->dstate);
+            }
+            else if constexpr(isBitParallelEngine<E>()) {
+                return this->bp->template allRejected<bitParallelEngineWords<E>()>(this->bstate);
+            }
+            else if constexpr(E == ExecutorEngine::LazyDFA) {
+                return this->lazydfa->allRejected(this->dstate);
+            }
+            else {
+                return this->m->allRejected(this->cstates);
+            }
+        }
 
-        NFAExecutor(const NFAExecutor& other) = default;
-        NFAExecutor(NFAExecutor&& other) = default;
+        //true if the machine has any state where every extension of the input is accepted
+        template <ExecutorEngine E>
+        inline bool canAcceptAll() const 
+        { 
+            if constexpr(E == ExecutorEngine::DFA) {
+                return this->dfa->universalstate != DFA_UNKNOWN_STATE;
+            }
+            else if constexpr(isBitParallelEngine<E>()) {
+                return this->bp->hasuniversal;
+            }
+            else {
+                return this->m->hasuniversal;
+            }
+        }
 
-        NFAExecutor& operator=(const NFAExecutor& other) = default;
-        NFAExecutor& operator=(NFAExecutor&& other) = default;
+        template <ExecutorEngine E>
+        inline bool acceptsAll() const 
+        { 
+            if constexpr(E == ExecutorEngine::DFA) {
+                return this->dfa->allAccepted(this->dstate);
+            }
+            else if constexpr(isBitParallelEngine<E>()) {
+                return this->bp->template allAccepted<bitParallelEngineWords<E>()>(this->bstate);
+            }
+            else if constexpr(E == ExecutorEngine::LazyDFA) {
+                return this->lazydfa->allAccepted(this->dstate);
+            }
+            else {
+                return this->m->allAccepted(this->cstates);
+            }
+        }
 
-        bool test(TStr* sstr, int64_t spos, int64_t epos)
+        //true if the search machine is idle in its leading .* -- the NFA engine never reports idle (so it only skips to the first candidate)
+        template <ExecutorEngine E>
+        inline bool inIdle() const 
+        { 
+            if constexpr(E == ExecutorEngine::DFA) {
+                return this->dstate == this->dfaidle;
+            }
+            else if constexpr(isBitParallelEngine<E>()) {
+                bool same = true;
+                for(size_t i = 0; i < bitParallelEngineWords<E>(); ++i) {
+                    same &= (this->bstate[i] == this->bpidle[i]);
+                }
+                return same;
+            }
+            else if constexpr(E == ExecutorEngine::LazyDFA) {
+                return this->lazydfa->inIdle(this->dstate);
+            }
+            else {
+                return false;
+            }
+        }
+
+        //move the iterator to the next candidate start if the search machine will just stay idle until then
+        template <ExecutorEngine E>
+        inline void skipIdle(TStr* sstr, int64_t epos)
+        {
+            if(this->skipidle && this->inIdle<E>()) {
+                this->iter.curr = this->scanner.next(sstr, this->iter.curr, epos);
+            }
+        }
+
+        //the start state moves to the idle state on any byte that cannot start a match so a search can begin at the first candidate
+        inline void skipToFirstCandidate(TStr* sstr, int64_t epos)
+        {
+            if(this->skipidle) {
+                this->iter.curr = this->scanner.next(sstr, this->iter.curr, epos);
+            }
+        }
+
+        template <ExecutorEngine E>
+        bool testImpl(TStr* sstr, int64_t spos, int64_t epos)
         {
-            this->m = this->forward;
             this->iter = TIter{sstr, spos, epos, spos};
 
-            this->runIntialStep();
+            this->runIntialStep<E>();
+
+            //the rest of the input cannot change the result once the machine accepts all extensions -- hoisted so machines without such states pay nothing in the loop
+            const bool checkall = this->canAcceptAll<E>();
+            if(checkall && this->acceptsAll<E>()) {
+                return true;
+            }
+
             while(this->iter.valid()) {
-                this->runStep(this->iter.get());
+                this->runStep<E>(this->iter.get());
                 this->iter.inc();
 
-                if(this->rejected()) {
+                if(this->rejected<E>()) {
                     return false;
                 }
+
+                if(checkall && this->acceptsAll<E>()) {
+                    return true;
+                }
             }
 
-            return this->accepted();
+            return this->accepted<E>();
         }
 
-        bool matchTestForward(TStr* sstr, int64_t spos, int64_t epos)
+        template <ExecutorEngine E>
+        bool matchTestForwardImpl(TStr* sstr, int64_t spos, int64_t epos)
         {
-            this->m = this->forward;
             this->iter = TIter{sstr, spos, epos, spos};
 
-            this->runIntialStep();
-            while(this->iter.valid() && !(this->accepted() || this->rejected())) {
-                this->runStep(this->iter.get());
+            this->runIntialStep<E>();
+            this->skipToFirstCandidate(sstr, epos);
+            while(this->iter.valid() && !(this->accepted<E>() || this->rejected<E>())) {
+                this->runStep<E>(this->iter.get());
                 this->iter.inc();
+
+                this->skipIdle<E>(sstr, epos);
             }
 
-            return this->accepted();
+            return this->accepted<E>();
         }
 
-        bool matchTestReverse(TStr* sstr, int64_t spos, int64_t epos)
+        template <ExecutorEngine E>
+        bool matchTestReverseImpl(TStr* sstr, int64_t spos, int64_t epos)
         {
-            this->m = this->reverse;
             this->iter = TIter{sstr, spos, epos, epos};
+            this->iter.toCharStart();
 
-            this->runIntialStep();
-            while(this->iter.valid() && !(this->accepted() || this->rejected())) {
-                this->runStep(this->iter.get());
+            this->runIntialStep<E>();
+            while(this->iter.valid() && !(this->accepted<E>() || this->rejected<E>())) {
+                this->runStep<E>(this->iter.get());
                 this->iter.dec();
             }
 
-            return this->accepted();
+            return this->accepted<E>();
         }
 
-        std::vector<int64_t> matchForward(TStr* sstr, int64_t spos, int64_t epos)
+        //call emit with the index of each accepted position (in order) until it returns false and return how many there were
+        template <ExecutorEngine E, typename TEmit>
+        size_t matchForwardImpl(TStr* sstr, int64_t spos, int64_t epos, TEmit emit)
         {
-            this->m = this->forward;
             this->iter = TIter{sstr, spos, epos, spos};
 
-            std::vector<int64_t> matches;
-            this->runIntialStep();
-            while(this->iter.valid() && !this->rejected()) {
-                this->runStep(this->iter.get());
+            size_t count = 0;
+            this->runIntialStep<E>();
+            this->skipToFirstCandidate(sstr, epos);
+            while(this->iter.valid() && !this->rejected<E>()) {
+                this->runStep<E>(this->iter.get());
 
-                if(this->accepted()) {
-                    matches.push_back(this->iter.curr);
+                if(this->accepted<E>()) {
+                    count++;
+                    if(!emit(this->iter.curr)) {
+                        break;
+                    }
                 }
 
                 this->iter.inc();
+
+                this->skipIdle<E>(sstr, epos);
+            }
+
+            return count;
+        }
+
+        template <ExecutorEngine E, typename TEmit>
+        size_t matchReverseImpl(TStr* sstr, int64_t spos, int64_t epos, TEmit emit)
+        {
+            this->iter = TIter{sstr, spos, epos, epos};
+            this->iter.toCharStart();
+
+            size_t count = 0;
+            this->runIntialStep<E>();
+            while(this->iter.valid() && !this->rejected<E>()) {
+                this->runStep<E>(this->iter.get());
+
+                if(this->accepted<E>()) {
+                    count++;
+                    if(!emit(this->iter.curr)) {
+                        break;
+                    }
+                }
+
+                this->iter.dec();
             }
 
+            return count;
+        }
+
+        //a forward leftmost search with no live threads can jump to the next position that a match can start at
+        template <bool isforward>
+        inline void skipToNextStart(TStr* sstr, int64_t epos)
+        {
+            if constexpr(isforward) {
+                if(this->scanner.enabled()) {
+                    this->iter.curr = this->scanner.next(sstr, this->iter.curr, epos);
+                }
+            }
+        }
+
+        //Pike style leftmost search on a machine without counters -- a thread is injected (tagged with the position) at every step until one accepts and then lower priority threads are dropped
+        //returns the tag of the winning thread and the furthest position it accepts at -- stopping as soon as no thread that could extend the match is left
+        //threads are only injected and accepted at the boundaries that bounds allows (a reverse search injects at the end of a match and accepts at its start)
+        template <bool isforward>
+        std::optional<std::pair<int64_t, int64_t>> taggedSearch(const NFAMachine* tm, TStr* sstr, int64_t spos, int64_t epos, const SpanBounds& bounds)
+        {
+            this->iter = TIter{sstr, spos, epos, isforward ? spos : epos};
+            if constexpr(!isforward) {
+                this->iter.toCharStart();
+            }
+
+            std::optional<std::pair<int64_t, int64_t>> best = std::nullopt;
+            this->skipToNextStart<isforward>(sstr, epos);
+            this->tcstates.intitialize(tm->program.size());
+            if(isforward ? bounds.canStart(this->iter.curr) : bounds.canEnd(epos + 1)) {
+                tm->injectTagged(this->tcstates, this->iter.curr);
+            }
+
+            while(this->iter.valid()) {
+                const int64_t pos = this->iter.curr;
+                tm->stepTagged(this->iter.get(), this->tcstates, this->tnstates);
+                if constexpr(isforward) {
+                    this->iter.inc();
+                }
+                else {
+                    this->iter.dec();
+                }
+
+                if(tm->inAcceptedTagged(this->tnstates) && (isforward ? bounds.canEnd(this->iter.curr) : bounds.canStart(pos))) {
+                    best = std::make_optional(std::make_pair(tm->acceptedTag(this->tnstates), pos));
+                }
+
+                if(best.has_value()) {
+                    this->tnstates.template dropAfter<isforward>(best->first);
+                    if(this->tnstates.states.empty()) {
+                        break;
+                    }
+                }
+                else {
+                    if(this->tnstates.states.empty()) {
+                        this->skipToNextStart<isforward>(sstr, epos);
+                    }
+
+                    if(isforward ? bounds.canStart(this->iter.curr) : bounds.canEnd(pos)) {
+                        tm->injectTagged(this->tnstates, this->iter.curr);
+                    }
+                }
+
+                this->tcstates.swap(this->tnstates);
+            }
+
+            return best;
+        }
+
+        //add a group that starts a thread at the start state tagged with tag after the first count groups
+        void injectGroup(const NFAMachine* tm, size_t count, int64_t tag)
+        {
+            if(this->gnstates.size() <= count) {
+                this->gnstates.resize(count + 1);
+                this->gntags.resize(count + 1, 0);
+            }
+
+            tm->intitializeMachine(this->gnstates[count], this->workset, this->fixpoint);
+            this->gntags[count] = tag;
+        }
+
+        //leftmost search on a machine with counters -- the same as taggedSearch but the threads that start at each position are kept together as a group (an NFAState) in priority order
+        //a group is dropped when all of its tokens are already in higher priority groups -- wherever it could accept one of those accepts too so it can never be the leftmost match
+        template <bool isforward>
+        std::optional<std::pair<int64_t, int64_t>> groupedSearch(const NFAMachine* tm, TStr* sstr, int64_t spos, int64_t epos, const SpanBounds& bounds)
+        {
+            this->iter = TIter{sstr, spos, epos, isforward ? spos : epos};
+            if constexpr(!isforward) {
+                this->iter.toCharStart();
+            }
+
+            std::optional<std::pair<int64_t, int64_t>> best = std::nullopt;
+            this->skipToNextStart<isforward>(sstr, epos);
+
+            size_t ccount = 0;
+            if(isforward ? bounds.canStart(this->iter.curr) : bounds.canEnd(epos + 1)) {
+                this->injectGroup(tm, 0, this->iter.curr);
+                ccount = 1;
+            }
+            std::swap(this->gcstates, this->gnstates);
+            std::swap(this->gctags, this->gntags);
+
+            while(this->iter.valid() && (ccount != 0 || !best.has_value())) {
+                const int64_t pos = this->iter.curr;
+                const RegexChar c = this->iter.get();
+                if constexpr(isforward) {
+                    this->iter.inc();
+                }
+                else {
+                    this->iter.dec();
+                }
+
+                this->gcovered.intitialize(tm->program.size(), tm->countingsets.size(), tm->countingwordcount);
+
+                const bool canaccept = isforward ? bounds.canEnd(this->iter.curr) : bounds.canStart(pos);
+                size_t ncount = 0;
+                std::optional<size_t> accepted = std::nullopt;
+                for(size_t i = 0; i < ccount; ++i) {
+                    if(this->gnstates.size() <= ncount) {
+                        this->gnstates.resize(ncount + 1);
+                        this->gntags.resize(ncount + 1, 0);
+                    }
+
+                    NFAState& gstates = this->gnstates[ncount];
+                    tm->stepMachine(c, this->gcstates[i], gstates, this->workset, this->fixpoint);
+                    if(tm->allRejected(gstates) || this->gcovered.containsAll(gstates, tm->countingsets)) {
+                        continue;
+                    }
+
+                    this->gcovered.addAll(gstates, tm->countingsets);
+                    this->gntags[ncount] = this->gctags[i];
+                    if(canaccept && !accepted.has_value() && tm->inAccepted(gstates)) {
+                        accepted = std::make_optional(ncount);
+                    }
+                    ncount++;
+                }
+
+                if(accepted.has_value()) {
+                    best = std::make_optional(std::make_pair(this->gntags[accepted.value()], pos));
+                }
+
+                //the groups after the best one started after it
+                if(best.has_value()) {
+                    while(ncount != 0 && (isforward ? (this->gntags[ncount - 1] > best->first) : (this->gntags[ncount - 1] < best->first))) {
+                        ncount--;
+                    }
+                }
+                else {
+                    if(ncount == 0) {
+                        this->skipToNextStart<isforward>(sstr, epos);
+                    }
+
+                    if(isforward ? bounds.canStart(this->iter.curr) : bounds.canEnd(pos)) {
+                        this->injectGroup(tm, ncount, this->iter.curr);
+                        ncount++;
+                    }
+                }
+
+                std::swap(this->gcstates, this->gnstates);
+                std::swap(this->gctags, this->gntags);
+                ccount = ncount;
+            }
+
+            return best;
+        }
+
+        //run op on each window of [spos, epos] that can hold a match (the whole range if there is no prefilter) until it returns true
+        template <typename TOp>
+        bool forEachWindow(TStr* sstr, int64_t spos, int64_t epos, TOp op)
+        {
+            if(!this->prefilter.enabled()) {
+                return op(spos, epos);
+            }
+
+            int64_t from = spos;
+            int64_t wspos = spos;
+            int64_t wepos = epos;
+            while(this->prefilter.nextWindow(sstr, from, spos, epos, wspos, wepos)) {
+                if(op(wspos, wepos)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        bool searchTestRange(TStr* sstr, int64_t spos, int64_t epos)
+        {
+            return this->runOnEngine(ExecutorDirection::ForwardSearch, [&](auto engine) { return this->template matchTestForwardImpl<decltype(engine)::value>(sstr, spos, epos); });
+        }
+
+        //the grouped search keeps a group per start that is still counting so a large bounded counter makes it O(n * bound) -- when matches are at most maxchars long (and the search is not guarded) the search machines find the span instead
+        inline bool canSearchBoundedSpan(const NFAMachine* tm, const SpanBounds& bounds) const
+        {
+            return !tm->canRunTagged() && this->prefilter.maxchars > 0 && bounds.starts == nullptr && bounds.ends == nullptr;
+        }
+
+        //the leftmost match starts at or before the first end a forward search finds so it ends within maxchars chars after it -- a reverse search of [spos, that] finds the leftmost start
+        std::optional<std::pair<int64_t, int64_t>> firstBoundedSpanRange(TStr* sstr, int64_t spos, int64_t epos)
+        {
+            int64_t firstend = spos - 1;
+            this->runOnEngine(ExecutorDirection::ForwardSearch, [&](auto engine) { 
+                firstend = spos - 1;
+                return this->template matchForwardImpl<decltype(engine)::value>(sstr, spos, epos, [&firstend](int64_t pos) { firstend = pos; return false; }); 
+            });
+
+            if(firstend < spos) {
+                return std::nullopt;
+            }
+
+            const int64_t wepos = this->prefilter.forwardChars(sstr, firstend, this->prefilter.maxchars, epos) - 1;
+            int64_t start = firstend;
+            this->runOnEngine(ExecutorDirection::ReverseSearch, [&](auto engine) { 
+                start = firstend;
+                return this->template matchReverseImpl<decltype(engine)::value>(sstr, spos, wepos, [&start](int64_t pos) { start = pos; return true; }); 
+            });
+
+            return std::make_optional(std::make_pair(start, this->matchForwardLongest(sstr, start, epos).value()));
+        }
+
+        //the rightmost match ends at or after the last start a reverse search finds so it starts within maxchars chars before it -- a forward search of [that, epos] finds the rightmost end
+        std::optional<std::pair<int64_t, int64_t>> lastBoundedSpanRange(TStr* sstr, int64_t spos, int64_t epos)
+        {
+            int64_t laststart = epos + 1;
+            this->runOnEngine(ExecutorDirection::ReverseSearch, [&](auto engine) { 
+                laststart = epos + 1;
+                return this->template matchReverseImpl<decltype(engine)::value>(sstr, spos, epos, [&laststart](int64_t pos) { laststart = pos; return false; }); 
+            });
+
+            if(laststart > epos) {
+                return std::nullopt;
+            }
+
+            const int64_t wspos = this->prefilter.backChars(sstr, laststart, this->prefilter.maxchars - 1, spos);
+            int64_t end = laststart;
+            this->runOnEngine(ExecutorDirection::ForwardSearch, [&](auto engine) { 
+                end = laststart;
+                return this->template matchForwardImpl<decltype(engine)::value>(sstr, wspos, epos, [&end](int64_t pos) { end = pos; return true; }); 
+            });
+
+            return std::make_optional(std::make_pair(this->matchReverseLongest(sstr, spos, end).value(), end));
+        }
+
+        //the leftmost search reports a miss itself (one pass over the range) -- skipping the stretches where no thread is alive with the first-char scanner
+        std::optional<std::pair<int64_t, int64_t>> firstSpanRange(TStr* sstr, int64_t spos, int64_t epos, const SpanBounds& bounds)
+        {
+            if(this->forward->canRunTagged()) {
+                return this->taggedSearch<true>(this->forward, sstr, spos, epos, bounds);
+            }
+            else if(this->canSearchBoundedSpan(this->forward, bounds)) {
+                return this->firstBoundedSpanRange(sstr, spos, epos);
+            }
+            else {
+                return this->groupedSearch<true>(this->forward, sstr, spos, epos, bounds);
+            }
+        }
+
+        std::optional<std::pair<int64_t, int64_t>> lastSpanRange(TStr* sstr, int64_t spos, int64_t epos, const SpanBounds& bounds)
+        {
+            if(this->canSearchBoundedSpan(this->reverse, bounds)) {
+                return this->lastBoundedSpanRange(sstr, spos, epos);
+            }
+
+            auto best = this->reverse->canRunTagged() ? this->taggedSearch<false>(this->reverse, sstr, spos, epos, bounds) : this->groupedSearch<false>(this->reverse, sstr, spos, epos, bounds);
+            return best.has_value() ? std::make_optional(std::make_pair(best->second, best->first)) : std::nullopt;
+        }
+
+        //one forward search pass finds the last index a match ends at and one reverse search pass finds the indices matches start at (in decreasing order) -- returns the last end (spos - 1 on a miss)
+        int64_t spanStartsRange(TStr* sstr, int64_t spos, int64_t epos, std::vector<int64_t>& starts)
+        {
+            starts.clear();
+
+            int64_t lastend = spos - 1;
+            this->runOnEngine(ExecutorDirection::ForwardSearch, [&](auto engine) { 
+                lastend = spos - 1;
+                return this->template matchForwardImpl<decltype(engine)::value>(sstr, spos, epos, [&lastend](int64_t pos) { lastend = pos; return true; }); 
+            });
+
+            if(lastend < spos) {
+                return lastend;
+            }
+
+            this->runOnEngine(ExecutorDirection::ReverseSearch, [&](auto engine) { 
+                starts.clear();
+                return this->template matchReverseImpl<decltype(engine)::value>(sstr, spos, lastend, [&starts](int64_t pos) { starts.push_back(pos); return true; }); 
+            });
+
+            return lastend;
+        }
+
+        //so anchored matching only runs from real starts (and not at all on a miss)
+        void matchSpansRange(TStr* sstr, int64_t spos, int64_t epos, std::vector<std::pair<int64_t, int64_t>>& spans)
+        {
+            std::vector<int64_t> starts;
+            const int64_t lastend = this->spanStartsRange(sstr, spos, epos, starts);
+            if(lastend < spos) {
+                return;
+            }
+
+            for(auto siter = starts.crbegin(); siter != starts.crend(); ++siter) {
+                const int64_t start = *siter;
+                const size_t startcount = spans.size();
+                this->runOnEngine(ExecutorDirection::Forward, [&](auto engine) { 
+                    spans.resize(startcount, std::make_pair(0, 0));
+                    return this->template matchForwardImpl<decltype(engine)::value>(sstr, start, lastend, [&spans, start](int64_t pos) { spans.push_back(std::make_pair(start, pos)); return true; }); 
+                });
+            }
+        }
+
+        //a lazy DFA is only needed if there is no AOT DFA or bit-parallel machine for m -- it runs on the char classes of the regex which are shared by all of the match contexts
+        static LazyDFAMachine buildLazyMachine(const NFAMachine* m, const DFAMachine* dfa, const BitParallelMachine* bp, std::shared_ptr<const CharClassMap> classes)
+        {
+            if(m == nullptr || dfa != nullptr || bp != nullptr || !LazyDFAMachine::canDeterminize(m)) {
+                return LazyDFAMachine();
+            }
+
+            return LazyDFAMachine(m, classes);
+        }
+
+        //the lazy DFAs are passed in so a match context can share their char classes (and only gets new caches)
+        NFAExecutor(const NFAMachine* forward, const NFAMachine* reverse, const NFAMachine* forwardsearch, const NFAMachine* reversesearch, const DFAMachine* dfaforward, const DFAMachine* dfareverse, const DFAMachine* dfaforwardsearch, const DFAMachine* dfareversesearch, const BitParallelMachine* bpforward, const BitParallelMachine* bpreverse, const BitParallelMachine* bpforwardsearch, const BitParallelMachine* bpreversesearch, const LiteralPrefilter<TStr>& prefilter, const FirstCharScanner& scanner, const LazyDFAMachine& lazyforward, const LazyDFAMachine& lazyreverse, const LazyDFAMachine& lazyforwardsearch, const LazyDFAMachine& lazyreversesearch) : forward(forward), reverse(reverse), forwardsearch(forwardsearch), reversesearch(reversesearch), dfaforward(dfaforward), dfareverse(dfareverse), dfaforwardsearch(dfaforwardsearch), dfareversesearch(dfareversesearch), bpforward(bpforward), bpreverse(bpreverse), bpforwardsearch(bpforwardsearch), bpreversesearch(bpreversesearch), iter(), m(nullptr), cstates(), nstates(), workset(), fixpoint(), prefilter(prefilter), scanner(scanner), skipidle(false), dfaidle(DFA_UNKNOWN_STATE), bpidle(), tcstates(), tnstates(), gcstates(), gnstates(), gctags(), gntags(), gcovered(), lazyforward(lazyforward), lazyreverse(lazyreverse), lazyforwardsearch(lazyforwardsearch), lazyreversesearch(lazyreversesearch), dfa(nullptr), lazydfa(nullptr), dstate(DFA_DEAD_STATE), bp(nullptr), bstate()
+        {
+            //the idle state is where the search machine goes from its start state on a char that cannot start a match
+            if(this->scanner.enabled()) {
+                if(this->dfaforwardsearch != nullptr) {
+                    this->dfaidle = this->dfaforwardsearch->stepMachine(this->dfaforwardsearch->intitializeMachine(), this->scanner.idlechar);
+                }
+
+                if(this->bpforwardsearch != nullptr) {
+                    this->bpidle.fill(0);
+                    this->bpidle[0] = 1;
+                    if(this->bpforwardsearch->wordcount == 1) {
+                        this->bpforwardsearch->template stepMachine<1>(this->bpidle, this->scanner.idlechar);
+                    }
+                    else if(this->bpforwardsearch->wordcount == 2) {
+                        this->bpforwardsearch->template stepMachine<2>(this->bpidle, this->scanner.idlechar);
+                    }
+                    else {
+                        this->bpforwardsearch->template stepMachine<4>(this->bpidle, this->scanner.idlechar);
+                    }
+                }
+
+                this->lazyforwardsearch.markIdle(this->scanner.idlechar);
+            }
+        }
+
+    public:
+        NFAExecutor(): forward(nullptr), reverse(nullptr), forwardsearch(nullptr), reversesearch(nullptr), dfaforward(nullptr), dfareverse(nullptr), dfaforwardsearch(nullptr), dfareversesearch(nullptr), bpforward(nullptr), bpreverse(nullptr), bpforwardsearch(nullptr), bpreversesearch(nullptr), iter(), m(nullptr), cstates(), nstates(), workset(), fixpoint(), prefilter(), scanner(), skipidle(false), dfaidle(DFA_UNKNOWN_STATE), bpidle(), tcstates(), tnstates(), gcstates(), gnstates(), gctags(), gntags(), gcovered(), lazyforward(), lazyreverse(), lazyforwardsearch(), lazyreversesearch(), dfa(nullptr), lazydfa(nullptr), dstate(DFA_DEAD_STATE), bp(nullptr), bstate() {;}
+        NFAExecutor(const NFAMachine* forward, const NFAMachine* reverse, const NFAMachine* forwardsearch, const NFAMachine* reversesearch, const DFAMachine* dfaforward, const DFAMachine* dfareverse, const DFAMachine* dfaforwardsearch, const DFAMachine* dfareversesearch, const BitParallelMachine* bpforward, const BitParallelMachine* bpreverse, const BitParallelMachine* bpforwardsearch, const BitParallelMachine* bpreversesearch, const LiteralPrefilter<TStr>& prefilter, const FirstCharScanner& scanner, std::shared_ptr<const CharClassMap> classes) : NFAExecutor(forward, reverse, forwardsearch, reversesearch, dfaforward, dfareverse, dfaforwardsearch, dfareversesearch, bpforward, bpreverse, bpforwardsearch, bpreversesearch, prefilter, scanner, NFAExecutor::buildLazyMachine(forward, dfaforward, bpforward, classes), NFAExecutor::buildLazyMachine(reverse, dfareverse, bpreverse, classes), NFAExecutor::buildLazyMachine(forwardsearch, dfaforwardsearch, bpforwardsearch, classes), NFAExecutor::buildLazyMachine(reversesearch, dfareversesearch, bpreversesearch, classes)) {;}
+        ~NFAExecutor() = default;
+
+        NFAExecutor(const NFAExecutor& other) = default;
+        NFAExecutor(NFAExecutor&& other) = default;
+
+        NFAExecutor& operator=(const NFAExecutor& other) = default;
+        NFAExecutor& operator=(NFAExecutor&& other) = default;
+
+        //a new executor on the same compiled machines (and lazy DFA char classes) with its own (empty) search state and lazy DFA caches -- so it can run concurrently with this one
+        NFAExecutor createMatchContext() const
+        {
+            return NFAExecutor(this->forward, this->reverse, this->forwardsearch, this->reversesearch, this->dfaforward, this->dfareverse, this->dfaforwardsearch, this->dfareversesearch, this->bpforward, this->bpreverse, this->bpforwardsearch, this->bpreversesearch, this->prefilter, this->scanner, this->lazyforward.createMatchContext(), this->lazyreverse.createMatchContext(), this->lazyforwardsearch.createMatchContext(), this->lazyreversesearch.createMatchContext());
+        }
+
+        const NFAMachine* forwardMachine() const
+        {
+            return this->forward;
+        }
+
+        const NFAMachine* reverseMachine() const
+        {
+            return this->reverse;
+        }
+
+        //false for checks that are never used in unanchored searches (so there are no search machines)
+        bool canSearch() const
+        {
+            return this->forwardsearch != nullptr;
+        }
+
+        bool test(TStr* sstr, int64_t spos, int64_t epos)
+        {
+            return this->runOnEngine(ExecutorDirection::Forward, [&](auto engine) { return this->template testImpl<decltype(engine)::value>(sstr, spos, epos); });
+        }
+
+        bool matchTestForward(TStr* sstr, int64_t spos, int64_t epos)
+        {
+            return this->runOnEngine(ExecutorDirection::Forward, [&](auto engine) { return this->template matchTestForwardImpl<decltype(engine)::value>(sstr, spos, epos); });
+        }
+
+        //test if any substring is accepted in a single pass over the input -- the search machine accepts as soon as a match ends
+        bool searchTest(TStr* sstr, int64_t spos, int64_t epos)
+        {
+            //there is no start position in an empty range so (as with a scan over the starts) nothing is contained -- even if the regex accepts the empty string
+            if(spos > epos) {
+                return false;
+            }
+
+            return this->forEachWindow(sstr, spos, epos, [&](int64_t wspos, int64_t wepos) { return this->searchTestRange(sstr, wspos, wepos); });
+        }
+
+        bool matchTestReverse(TStr* sstr, int64_t spos, int64_t epos)
+        {
+            return this->runOnEngine(ExecutorDirection::Reverse, [&](auto engine) { return this->template matchTestReverseImpl<decltype(engine)::value>(sstr, spos, epos); });
+        }
+
+        //call visit with each accepted end position (in order) until it returns false
+        //a lazy DFA that gives up is rerun on the NFA so positions that were already visited are skipped on the rerun
+        template <typename TVisit>
+        void visitForward(TStr* sstr, int64_t spos, int64_t epos, TVisit visit)
+        {
+            int64_t last = spos - 1;
+            this->runOnEngine(ExecutorDirection::Forward, [&](auto engine) { 
+                return this->template matchForwardImpl<decltype(engine)::value>(sstr, spos, epos, [&last, &visit](int64_t pos) {
+                    if(pos <= last) {
+                        return true;
+                    }
+
+                    last = pos;
+                    return (bool)visit(pos);
+                }); 
+            });
+        }
+
+        //call visit with each accepted start position (from epos back to spos) until it returns false
+        template <typename TVisit>
+        void visitReverse(TStr* sstr, int64_t spos, int64_t epos, TVisit visit)
+        {
+            int64_t last = epos + 1;
+            this->runOnEngine(ExecutorDirection::Reverse, [&](auto engine) { 
+                return this->template matchReverseImpl<decltype(engine)::value>(sstr, spos, epos, [&last, &visit](int64_t pos) {
+                    if(pos >= last) {
+                        return true;
+                    }
+
+                    last = pos;
+                    return (bool)visit(pos);
+                }); 
+            });
+        }
+
+        //the end of the longest match from spos -- no positions are materialized
+        std::optional<int64_t> matchForwardLongest(TStr* sstr, int64_t spos, int64_t epos)
+        {
+            std::optional<int64_t> res = std::nullopt;
+            this->visitForward(sstr, spos, epos, [&res](int64_t pos) { res = std::make_optional(pos); return true; });
+
+            return res;
+        }
+
+        //the end of the shortest match from spos -- stops at the first accepted position
+        std::optional<int64_t> matchForwardShortest(TStr* sstr, int64_t spos, int64_t epos)
+        {
+            std::optional<int64_t> res = std::nullopt;
+            this->visitForward(sstr, spos, epos, [&res](int64_t pos) { res = std::make_optional(pos); return false; });
+
+            return res;
+        }
+
+        std::optional<int64_t> matchReverseLongest(TStr* sstr, int64_t spos, int64_t epos)
+        {
+            std::optional<int64_t> res = std::nullopt;
+            this->visitReverse(sstr, spos, epos, [&res](int64_t pos) { res = std::make_optional(pos); return true; });
+
+            return res;
+        }
+
+        std::optional<int64_t> matchReverseShortest(TStr* sstr, int64_t spos, int64_t epos)
+        {
+            std::optional<int64_t> res = std::nullopt;
+            this->visitReverse(sstr, spos, epos, [&res](int64_t pos) { res = std::make_optional(pos); return false; });
+
+            return res;
+        }
+
+        //replace the contents of a caller owned buffer with the accepted positions (so a reused buffer does not allocate)
+        void matchForwardInto(TStr* sstr, int64_t spos, int64_t epos, std::vector<int64_t>& matches)
+        {
+            matches.clear();
+            this->visitForward(sstr, spos, epos, [&matches](int64_t pos) { matches.push_back(pos); return true; });
+        }
+
+        void matchReverseInto(TStr* sstr, int64_t spos, int64_t epos, std::vector<int64_t>& matches)
+        {
+            matches.clear();
+            this->visitReverse(sstr, spos, epos, [&matches](int64_t pos) { matches.push_back(pos); return true; });
+        }
+
+        std::vector<int64_t> matchForward(TStr* sstr, int64_t spos, int64_t epos)
+        {
+            std::vector<int64_t> matches;
+            this->matchForwardInto(sstr, spos, epos, matches);
+
             return matches;
         }
 
         std::vector<int64_t> matchReverse(TStr* sstr, int64_t spos, int64_t epos)
         {
-            this->m = this->reverse;
+            std::vector<int64_t> matches;
+            this->matchReverseInto(sstr, spos, epos, matches);
+
+            return matches;
+        }
+
+        //the leftmost start and the longest match from it (non-empty) that starts and ends at boundaries bounds allows -- stops as soon as no thread that could extend the match is left
+        //the windows from the prefilter are disjoint and in order so the first window with a match has the leftmost one
+        std::optional<std::pair<int64_t, int64_t>> matchFirstSpan(TStr* sstr, int64_t spos, int64_t epos, const SpanBounds& bounds)
+        {
+            std::optional<std::pair<int64_t, int64_t>> res = std::nullopt;
+            this->forEachWindow(sstr, spos, epos, [&](int64_t wspos, int64_t wepos) {
+                res = this->firstSpanRange(sstr, wspos, wepos, bounds);
+                return res.has_value();
+            });
+
+            return res;
+        }
+
+        //the rightmost end and the longest match to it (non-empty) that starts and ends at boundaries bounds allows
+        std::optional<std::pair<int64_t, int64_t>> matchLastSpan(TStr* sstr, int64_t spos, int64_t epos, const SpanBounds& bounds)
+        {
+            std::vector<std::pair<int64_t, int64_t>> windows;
+            this->forEachWindow(sstr, spos, epos, [&windows](int64_t wspos, int64_t wepos) {
+                windows.push_back(std::make_pair(wspos, wepos));
+                return false;
+            });
+
+            for(auto witer = windows.crbegin(); witer != windows.crend(); ++witer) {
+                auto res = this->lastSpanRange(sstr, witer->first, witer->second, bounds);
+                if(res.has_value()) {
+                    return res;
+                }
+            }
+            return std::nullopt;
+        }
+
+        //mark (at b - spos) each boundary b in [spos, epos + 1] that an accepted substring ends just before -- in a single search pass
+        void markMatchEnds(TStr* sstr, int64_t spos, int64_t epos, std::vector<bool>& marks)
+        {
+            marks.assign((size_t)(epos - spos + 2), false);
+            marks[0] = this->forward->acceptsEmpty();
+
+            this->forEachWindow(sstr, spos, epos, [&](int64_t wspos, int64_t wepos) {
+                this->runOnEngine(ExecutorDirection::ForwardSearch, [&](auto engine) { 
+                    std::fill(marks.begin() + (wspos - spos + 1), marks.begin() + (wepos - spos + 2), false);
+                    return this->template matchForwardImpl<decltype(engine)::value>(sstr, wspos, wepos, [&](int64_t pos) { 
+                        TIter niter{sstr, spos, epos, pos};
+                        niter.inc();
+
+                        marks[niter.curr - spos] = true;
+                        return true; 
+                    }); 
+                });
+                return false;
+            });
+        }
+
+        //mark (at b - spos) each boundary b in [spos, epos + 1] that an accepted substring starts at -- in a single reverse search pass
+        void markMatchStarts(TStr* sstr, int64_t spos, int64_t epos, std::vector<bool>& marks)
+        {
+            marks.assign((size_t)(epos - spos + 2), false);
+            marks[epos - spos + 1] = this->forward->acceptsEmpty();
+
+            this->forEachWindow(sstr, spos, epos, [&](int64_t wspos, int64_t wepos) {
+                this->runOnEngine(ExecutorDirection::ReverseSearch, [&](auto engine) { 
+                    std::fill(marks.begin() + (wspos - spos), marks.begin() + (wepos - spos + 1), false);
+                    return this->template matchReverseImpl<decltype(engine)::value>(sstr, wspos, wepos, [&](int64_t pos) { 
+                        marks[pos - spos] = true;
+                        return true; 
+                    }); 
+                });
+                return false;
+            });
+        }
+
+        //append the (start, end) spans of the non-empty substrings that are accepted (ordered by start and then end)
+        void matchSpans(TStr* sstr, int64_t spos, int64_t epos, std::vector<std::pair<int64_t, int64_t>>& spans)
+        {
+            this->forEachWindow(sstr, spos, epos, [&](int64_t wspos, int64_t wepos) {
+                this->matchSpansRange(sstr, wspos, wepos, spans);
+                return false;
+            });
+        }
+    };
+
+    //Runs the product DFA of several (binding) checks so that all of them are stepped in lockstep in a single pass over the input
+    template <typename TStr, typename TIter>
+    class DFAProductExecutor
+    {
+    private:
+        const DFAMachine* forward;
+        const DFAMachine* reverse;
+
+        TIter iter;
+
+    public:
+        DFAProductExecutor() : forward(nullptr), reverse(nullptr), iter() {;}
+        DFAProductExecutor(const DFAMachine* forward, const DFAMachine* reverse) : forward(forward), reverse(reverse), iter() {;}
+        ~DFAProductExecutor() = default;
+
+        DFAProductExecutor(const DFAProductExecutor& other) = default;
+        DFAProductExecutor(DFAProductExecutor&& other) = default;
+
+        DFAProductExecutor& operator=(const DFAProductExecutor& other) = default;
+        DFAProductExecutor& operator=(DFAProductExecutor&& other) = default;
+
+        bool test(TStr* sstr, int64_t spos, int64_t epos)
+        {
+            this->iter = TIter{sstr, spos, epos, spos};
+
+            DFAStateID s = this->forward->intitializeMachine();
+            while(this->iter.valid()) {
+                s = this->forward->stepMachine(s, this->iter.get());
+                this->iter.inc();
+
+                if(this->forward->allRejected(s)) {
+                    return false;
+                }
+
+                if(this->forward->allAccepted(s)) {
+                    return true;
+                }
+            }
+
+            return this->forward->inAccepted(s);
+        }
+
+        //call visit with each position where every check accepts (in order) until it returns false -- the same positions as intersecting the matches of each check
+        template <typename TVisit>
+        void visitForward(TStr* sstr, int64_t spos, int64_t epos, TVisit visit)
+        {
+            this->iter = TIter{sstr, spos, epos, spos};
+
+            DFAStateID s = this->forward->intitializeMachine();
+            while(this->iter.valid() && !this->forward->allRejected(s)) {
+                s = this->forward->stepMachine(s, this->iter.get());
+
+                if(this->forward->inAccepted(s) && !visit(this->iter.curr)) {
+                    return;
+                }
+
+                this->iter.inc();
+            }
+        }
+
+        template <typename TVisit>
+        void visitReverse(TStr* sstr, int64_t spos, int64_t epos, TVisit visit)
+        {
             this->iter = TIter{sstr, spos, epos, epos};
+            this->iter.toCharStart();
 
-            std::vector<int64_t> matches;
-            this->runIntialStep();
-            while(this->iter.valid() && !this->rejected()) {
-                this->runStep(this->iter.get());
+            DFAStateID s = this->reverse->intitializeMachine();
+            while(this->iter.valid() && !this->reverse->allRejected(s)) {
+                s = this->reverse->stepMachine(s, this->iter.get());
 
-                if(this->accepted()) {
-                    matches.push_back(this->iter.curr);
+                if(this->reverse->inAccepted(s) && !visit(this->iter.curr)) {
+                    return;
                 }
 
                 this->iter.dec();
             }
+        }
+
+        std::optional<int64_t> matchForwardLongest(TStr* sstr, int64_t spos, int64_t epos)
+        {
+            std::optional<int64_t> res = std::nullopt;
+            this->visitForward(sstr, spos, epos, [&res](int64_t pos) { res = std::make_optional(pos); return true; });
+
+            return res;
+        }
+
+        std::optional<int64_t> matchReverseLongest(TStr* sstr, int64_t spos, int64_t epos)
+        {
+            std::optional<int64_t> res = std::nullopt;
+            this->visitReverse(sstr, spos, epos, [&res](int64_t pos) { res = std::make_optional(pos); return true; });
+
+            return res;
+        }
+
+        void matchForwardInto(TStr* sstr, int64_t spos, int64_t epos, std::vector<int64_t>& matches)
+        {
+            matches.clear();
+            this->visitForward(sstr, spos, epos, [&matches](int64_t pos) { matches.push_back(pos); return true; });
+        }
+
+        void matchReverseInto(TStr* sstr, int64_t spos, int64_t epos, std::vector<int64_t>& matches)
+        {
+            matches.clear();
+            this->visitReverse(sstr, spos, epos, [&matches](int64_t pos) { matches.push_back(pos); return true; });
+        }
+
+        std::vector<int64_t> matchForward(TStr* sstr, int64_t spos, int64_t epos)
+        {
+            std::vector<int64_t> matches;
+            this->matchForwardInto(sstr, spos, epos, matches);
+
+            return matches;
+        }
+
+        std::vector<int64_t> matchReverse(TStr* sstr, int64_t spos, int64_t epos)
+        {
+            std::vector<int64_t> matches;
+            this->matchReverseInto(sstr, spos, epos, matches);
 
             return matches;
         }
@@ -7,163 +7,452 @@ namespace brex
         return count == UINT16_MAX ? count : count + 1;
     }
 
-    bool NFAMachine::inAccepted(const NFAState& ostates) const
+    std::vector<SingleCharRange> normalizeCharRanges(bool compliment, const std::vector<SingleCharRange>& ranges)
     {
-        return ostates.simplestates.find(this->acceptstate) != ostates.simplestates.cend();
-    }
+        std::vector<SingleCharRange> sorted(ranges);
+        std::sort(sorted.begin(), sorted.end(), [](const SingleCharRange& r1, const SingleCharRange& r2) {
+            return r1.low < r2.low;
+        });
 
-    bool NFAMachine::allRejected(const NFAState& ostates) const
-    {
-        return ostates.simplestates.empty() && ostates.singlestates.empty() && ostates.fullstates.empty();
+        //merge overlapping and adjacent ranges
+        std::vector<SingleCharRange> merged;
+        for(auto iter = sorted.cbegin(); iter != sorted.cend(); ++iter) {
+            if(!merged.empty() && (merged.back().high == UINT32_MAX || iter->low <= merged.back().high + 1)) {
+                merged.back().high = std::max(merged.back().high, iter->high);
+            }
+            else {
+                merged.push_back(*iter);
+            }
+        }
+
+        if(!compliment) {
+            return merged;
+        }
+
+        //the gaps between the merged ranges
+        std::vector<SingleCharRange> gaps;
+        RegexChar next = 0;
+        bool done = false;
+        for(auto iter = merged.cbegin(); iter != merged.cend(); ++iter) {
+            if(next < iter->low) {
+                gaps.push_back(SingleCharRange{ next, iter->low - 1 });
+            }
+
+            done = (iter->high == UINT32_MAX);
+            next = iter->high + 1;
+        }
+
+        if(!done) {
+            gaps.push_back(SingleCharRange{ next, UINT32_MAX });
+        }
+
+        return gaps;
     }
 
-    void NFAMachine::advanceCharForSimpleStates(RegexChar c, const NFAState& ostates, NFAEpsilonWorkSet& workset, NFAState& nstates) const
+    NFAProgram NFAProgram::assemble(const std::vector<NFAOpt*>& nfaopts)
     {
-        for(auto iter = ostates.simplestates.cbegin(); iter != ostates.simplestates.cend(); ++iter) {
-            const NFAOpt* opt = this->nfaopts[iter->cstate];
-            const NFAOptTag tag = opt->tag;
+        NFAProgram program;
+        program.tags.reserve(nfaopts.size());
+        program.follows.reserve(nfaopts.size());
+        program.operands.reserve(nfaopts.size());
+
+        for(auto iter = nfaopts.cbegin(); iter != nfaopts.cend(); ++iter) {
+            const NFAOpt* opt = *iter;
 
-            switch(tag) {
+            StateID follow = 0;
+            uint32_t operand = 0;
+            switch(opt->tag) {
                 case NFAOptTag::CharCode: {
                     const NFAOptCharCode* cc = static_cast<const NFAOptCharCode*>(opt);
-                    if(cc->c == c) {
-                        this->addNextSimpleState(nstates, workset, iter->toNextState(cc->follow));
-                    }
+                    follow = cc->follow;
+                    operand = cc->c;
                     break;
                 }
                 case NFAOptTag::CharRange: {
                     const NFAOptRange* range = static_cast<const NFAOptRange*>(opt);
-                    auto inrng = std::find_if(range->ranges.cbegin(), range->ranges.cend(), [c](const SingleCharRange& rr) {
-                        return (rr.low <= c && c <= rr.high);
-                    }) != range->ranges.cend();
+                    follow = range->follow;
+                    operand = (uint32_t)program.rangesets.size();
+
+                    const std::vector<SingleCharRange> normalized = normalizeCharRanges(range->compliment, range->ranges);
 
-                    bool doinsert = !range->compliment == inrng; //either both true or both false
-                    if(doinsert) {
-                        this->addNextSimpleState(nstates, workset, iter->toNextState(range->follow));
+                    NFAProgramRangeSet rset{ (uint32_t)program.ranges.size(), (uint32_t)normalized.size(), { 0, 0 } };
+                    for(auto riter = normalized.cbegin(); riter != normalized.cend() && riter->low < NFA_RANGE_ASCII_LIMIT; ++riter) {
+                        const RegexChar rhigh = std::min(riter->high, (RegexChar)(NFA_RANGE_ASCII_LIMIT - 1));
+                        for(RegexChar c = riter->low; c <= rhigh; ++c) {
+                            rset.asciimask[c / 64] |= ((uint64_t)1 << (c % 64));
+                        }
                     }
+
+                    program.rangesets.push_back(rset);
+                    std::copy(normalized.cbegin(), normalized.cend(), std::back_inserter(program.ranges));
                     break;
                 }
                 case NFAOptTag::Dot: {
-                    const NFAOptDot* dot = static_cast<const NFAOptDot*>(opt);
-                    this->addNextSimpleState(nstates, workset, iter->toNextState(dot->follow));
+                    follow = static_cast<const NFAOptDot*>(opt)->follow;
+                    break;
+                }
+                case NFAOptTag::AnyOf: {
+                    const NFAOptAnyOf* anyof = static_cast<const NFAOptAnyOf*>(opt);
+                    operand = (uint32_t)program.followlists.size();
+
+                    program.followlists.push_back((StateID)anyof->follows.size());
+                    std::copy(anyof->follows.cbegin(), anyof->follows.cend(), std::back_inserter(program.followlists));
+                    break;
+                }
+                case NFAOptTag::Star: {
+                    const NFAOptStar* star = static_cast<const NFAOptStar*>(opt);
+                    follow = star->matchfollow;
+                    operand = star->skipfollow;
+                    break;
+                }
+                case NFAOptTag::RangeK: {
+                    const NFAOptRangeK* rngk = static_cast<const NFAOptRangeK*>(opt);
+                    follow = rngk->infollow;
+                    operand = (uint32_t)program.counters.size();
+
+                    program.counters.push_back(NFAProgramCounter{ rngk->outfollow, rngk->mink, rngk->maxk });
                     break;
                 }
                 default: {
-                    //No char transitions for these so just drop token
                     break;
                 }
             }
+
+            program.tags.push_back(opt->tag);
+            program.follows.push_back(follow);
+            program.operands.push_back(operand);
         }
+
+        //the program lives as long as its machine so it does not keep the spare capacity from building it
+        program.rangesets.shrink_to_fit();
+        program.ranges.shrink_to_fit();
+        program.followlists.shrink_to_fit();
+        program.counters.shrink_to_fit();
+
+        return program;
     }
 
-    void NFAMachine::advanceCharForSingleStates(RegexChar c, const NFAState& ostates, NFAEpsilonWorkSet& workset, NFAState& nstates) const
+    void NFAMachine::computeLiveStates()
     {
-        for(auto iter = ostates.singlestates.cbegin(); iter != ostates.singlestates.cend(); ++iter) {
-            const NFAOpt* opt = this->nfaopts[iter->cstate];
-            const NFAOptTag tag = opt->tag;
-
-            switch(tag) {
-                case NFAOptTag::CharCode: {
-                    const NFAOptCharCode* cc = static_cast<const NFAOptCharCode*>(opt);
-                    if(cc->c == c) {
-                        this->addNextSingleState(nstates, workset, iter->toNextState(cc->follow));
-                    }
+        //reverse edges of the machine -- counts are ignored so this is conservative for RangeKs
+        std::vector<std::vector<StateID>> preds(this->program.size());
+        for(StateID s = 0; s < this->program.size(); ++s) {
+            switch(this->program.tags[s]) {
+                case NFAOptTag::Accept: {
                     break;
                 }
                 case NFAOptTag::CharRange: {
-                    const NFAOptRange* range = static_cast<const NFAOptRange*>(opt);
-                    auto inrng = std::find_if(range->ranges.cbegin(), range->ranges.cend(), [c](const SingleCharRange& rr) {
-                        return (rr.low <= c && c <= rr.high);
-                    }) != range->ranges.cend();
-
-                    bool doinsert = !range->compliment == inrng; //either both true or both false
-                    if(doinsert) {
-                        this->addNextSingleState(nstates, workset, iter->toNextState(range->follow));
+                    //a range that matches no chars has no transition
+                    if(this->program.rangesets[this->program.operands[s]].count != 0) {
+                        preds[this->program.follows[s]].push_back(s);
                     }
                     break;
                 }
-                case NFAOptTag::Dot: {
-                    const NFAOptDot* dot = static_cast<const NFAOptDot*>(opt);
-                    this->addNextSingleState(nstates, workset, iter->toNextState(dot->follow));
+                case NFAOptTag::AnyOf: {
+                    for(auto iter = this->program.anyofFollowsBegin(s); iter != this->program.anyofFollowsEnd(s); ++iter) {
+                        preds[*iter].push_back(s);
+                    }
+                    break;
+                }
+                case NFAOptTag::Star: {
+                    preds[this->program.follows[s]].push_back(s);
+                    preds[this->program.starSkipFollow(s)].push_back(s);
+                    break;
+                }
+                case NFAOptTag::RangeK: {
+                    preds[this->program.follows[s]].push_back(s);
+                    preds[this->program.counter(s).outfollow].push_back(s);
                     break;
                 }
                 default: {
-                    //No char transitions for these so just drop token
+                    preds[this->program.follows[s]].push_back(s);
                     break;
                 }
             }
         }
+
+        this->livestates.assign(this->program.size(), false);
+        std::vector<StateID> pending = { this->acceptstate };
+        this->livestates[this->acceptstate] = true;
+        while(!pending.empty()) {
+            const StateID cs = pending.back();
+            pending.pop_back();
+
+            for(auto iter = preds[cs].cbegin(); iter != preds[cs].cend(); ++iter) {
+                if(!this->livestates[*iter]) {
+                    this->livestates[*iter] = true;
+                    pending.push_back(*iter);
+                }
+            }
+        }
     }
-        
-    void NFAMachine::advanceCharForFullStates(RegexChar c, const NFAState& ostates, NFAEpsilonWorkSet& workset, NFAState& nstates) const
+
+    void NFAMachine::computeUniversalStates()
     {
-        for(auto iter = ostates.fullstates.cbegin(); iter != ostates.fullstates.cend(); ++iter) {
-            const NFAOpt* opt = this->nfaopts[iter->cstate];
-            const NFAOptTag tag = opt->tag;
+        auto closureHas = [this](const NFAEpsilonClosure& closure, auto pred) {
+            const StateID* concretes = this->closurestates.data() + closure.start;
+            return std::any_of(concretes, concretes + closure.concretecount, pred);
+        };
 
-            switch(tag) {
-                case NFAOptTag::CharCode: {
-                    const NFAOptCharCode* cc = static_cast<const NFAOptCharCode*>(opt);
-                    if(cc->c == c) {
-                        this->addNextFullState(nstates, workset, iter->toNextState(cc->follow));
-                    }
-                    break;
+        //candidates accept any char and can accept right after it
+        this->universalstates.assign(this->program.size(), false);
+        for(StateID s = 0; s < this->program.size(); ++s) {
+            bool anychar = false;
+            if(this->program.tags[s] == NFAOptTag::Dot) {
+                anychar = true;
+            }
+            else if(this->program.tags[s] == NFAOptTag::CharRange) {
+                const NFAProgramRangeSet& rset = this->program.rangesets[this->program.operands[s]];
+                anychar = (rset.count == 1 && this->program.ranges[rset.start].low == 0 && this->program.ranges[rset.start].high == UINT32_MAX);
+            }
+            else {
+                ;
+            }
+
+            if(anychar && this->livestates[s]) {
+                this->universalstates[s] = closureHas(this->closures[this->program.follows[s]], [this](StateID cs) { return cs == this->acceptstate; });
+            }
+        }
+
+        //then drop the ones that cannot stay in the set until nothing changes
+        bool changed = true;
+        while(changed) {
+            changed = false;
+            for(StateID s = 0; s < this->program.size(); ++s) {
+                if(this->universalstates[s] && !closureHas(this->closures[this->program.follows[s]], [this](StateID cs) { return (bool)this->universalstates[cs]; })) {
+                    this->universalstates[s] = false;
+                    changed = true;
                 }
-                case NFAOptTag::CharRange: {
-                    const NFAOptRange* range = static_cast<const NFAOptRange*>(opt);
-                    auto inrng = std::find_if(range->ranges.cbegin(), range->ranges.cend(), [c](const SingleCharRange& rr) {
-                        return (rr.low <= c && c <= rr.high);
-                    }) != range->ranges.cend();
+            }
+        }
 
-                    bool doinsert = !range->compliment == inrng; //either both true or both false
-                    if(doinsert) {
-                        this->addNextFullState(nstates, workset, iter->toNextState(range->follow));
-                    }
+        this->hasuniversal = std::find(this->universalstates.cbegin(), this->universalstates.cend(), true) != this->universalstates.cend();
+        for(auto iter = this->closures.begin(); iter != this->closures.end(); ++iter) {
+            iter->universal = closureHas(*iter, [this](StateID cs) { return (bool)this->universalstates[cs]; });
+        }
+    }
+
+    void NFAMachine::computeEpsilonClosure(StateID s, NFAEpsilonClosure& closure)
+    {
+        std::vector<bool> visited(this->program.size(), false);
+        std::vector<StateID> pending = { s };
+        visited[s] = true;
+
+        std::vector<StateID> concretes;
+        std::vector<StateID> rangeks;
+        while(!pending.empty()) {
+            const StateID cs = pending.back();
+            pending.pop_back();
+
+            std::vector<StateID> nexts;
+            switch(this->program.tags[cs]) {
+                case NFAOptTag::AnyOf: {
+                    nexts.assign(this->program.anyofFollowsBegin(cs), this->program.anyofFollowsEnd(cs));
                     break;
                 }
-                case NFAOptTag::Dot: {
-                    const NFAOptDot* dot = static_cast<const NFAOptDot*>(opt);
-                    this->addNextFullState(nstates, workset, iter->toNextState(dot->follow));
+                case NFAOptTag::Star: {
+                    nexts = { this->program.follows[cs], this->program.starSkipFollow(cs) };
+                    break;
+                }
+                case NFAOptTag::RangeK: {
+                    if(this->livestates[cs]) {
+                        rangeks.push_back(cs);
+                    }
+                    if(this->program.counter(cs).mink == 0) {
+                        nexts = { this->program.counter(cs).outfollow };
+                    }
                     break;
                 }
                 default: {
-                    //No char transitions for these so just drop token
+                    if(this->livestates[cs]) {
+                        concretes.push_back(cs);
+                    }
                     break;
                 }
             }
+
+            for(auto iter = nexts.cbegin(); iter != nexts.cend(); ++iter) {
+                if(!visited[*iter]) {
+                    visited[*iter] = true;
+                    pending.push_back(*iter);
+                }
+            }
         }
+
+        std::sort(concretes.begin(), concretes.end());
+        std::sort(rangeks.begin(), rangeks.end());
+
+        closure.start = (uint32_t)this->closurestates.size();
+        closure.concretecount = (uint32_t)concretes.size();
+        closure.rangekcount = (uint32_t)rangeks.size();
+        closure.universal = false;
+        std::copy(concretes.cbegin(), concretes.cend(), std::back_inserter(this->closurestates));
+        std::copy(rangeks.cbegin(), rangeks.cend(), std::back_inserter(this->closurestates));
     }
 
-    void NFAMachine::advanceEpsilonForSimpleStates(NFAEpsilonFixpointSet& fixpoint, NFAEpsilonWorkSet& workset, NFAState& nstates) const
+    void NFAMachine::computeEpsilonClosures()
     {
-        while(workset.hasSimpleStates()) {
-            const NFASimpleStateToken stok = workset.getNextSimpleState();
+        this->closures.resize(this->program.size(), NFAEpsilonClosure{ 0, 0, 0, false });
+
+        std::vector<bool> entries(this->program.size(), false);
+        entries[this->startstate] = true;
+        for(StateID s = 0; s < this->program.size(); ++s) {
+            if(this->program.concreteTransition(s) && this->program.tags[s] != NFAOptTag::Accept) {
+                entries[this->program.follows[s]] = true;
+            }
+            else if(this->program.tags[s] == NFAOptTag::RangeK) {
+                entries[this->program.counter(s).outfollow] = true;
+            }
+            else {
+                ;
+            }
+        }
+
+        for(StateID s = 0; s < this->program.size(); ++s) {
+            if(entries[s]) {
+                this->computeEpsilonClosure(s, this->closures[s]);
+            }
+        }
+    }
 
-            const NFAOpt* opt = this->nfaopts[stok.cstate];
-            const NFAOptTag tag = opt->tag;
+    void NFAMachine::computeCountingSets()
+    {
+        this->countingsetindex.resize(this->program.size(), NFA_NO_COUNTING_SET);
+
+        for(StateID s = 0; s < this->program.size(); ++s) {
+            if(this->program.tags[s] != NFAOptTag::RangeK) {
+                continue;
+            }
+
+            const StateID body = this->program.follows[s];
+            if(!this->program.concreteTransition(body) || this->program.tags[body] == NFAOptTag::Accept || this->program.follows[body] != s) {
+                continue;
+            }
+
+            const NFAProgramCounter& rngk = this->program.counter(s);
+            const bool saturating = (rngk.maxk == UINT16_MAX);
+            const uint16_t limit = saturating ? std::max(rngk.mink, (uint16_t)1) : rngk.maxk;
+            const uint32_t wordcount = (limit / 64) + 1;
+
+            this->countingsetindex[s] = (uint32_t)this->countingsets.size();
+            this->countingsets.push_back(NFACountingSetInfo{ s, body, rngk.outfollow, rngk.mink, limit, saturating, (uint32_t)this->countingwordcount, wordcount });
+            this->countingwordcount += wordcount;
+        }
+    }
+
+    bool NFAMachine::inAccepted(const NFAState& ostates) const
+    {
+        return ostates.simplestates.contains(this->acceptstate);
+    }
+
+    bool NFAMachine::acceptsEmpty() const
+    {
+        NFAState cstates;
+        NFAEpsilonWorkSet workset;
+        NFAEpsilonFixpointSet fixpoint;
+        this->intitializeMachine(cstates, workset, fixpoint);
+
+        return this->inAccepted(cstates);
+    }
+
+    bool NFAMachine::allRejected(const NFAState& ostates) const
+    {
+        return ostates.simplestates.empty() && ostates.singlestates.empty() && ostates.fullstates.empty() && ostates.countingsets.allEmpty();
+    }
+
+    void NFAMachine::advanceCharForCountingSets(RegexChar c, const NFAState& ostates, NFAEpsilonWorkSet& workset, NFAState& nstates) const
+    {
+        for(size_t i = 0; i < this->countingsets.size(); ++i) {
+            const NFACountingSetInfo& cinfo = this->countingsets[i];
+            if(ostates.countingsets.empty(i) || !this->program.charTest(cinfo.body, c)) {
+                continue;
+            }
+
+            //every token completed an iteration -- those with count >= mink can exit and those below the limit loop again
+            if(ostates.countingsets.anyAtLeast(i, cinfo, cinfo.mink)) {
+                this->addNextSimpleClosure(nstates, workset, cinfo.outfollow);
+            }
+
+            nstates.countingsets.addIncremented(i, cinfo, ostates.countingsets);
+        }
+    }
+
+    void NFAMachine::advanceCharForSimpleStates(RegexChar c, const NFAState& ostates, NFAEpsilonWorkSet& workset, NFAState& nstates) const
+    {
+        for(auto iter = ostates.simplestates.cbegin(); iter != ostates.simplestates.cend(); ++iter) {
+            //states without char transitions (Accept) just drop the token
+            if(this->program.charTest(*iter, c)) {
+                this->addNextSimpleClosure(nstates, workset, this->program.follows[*iter]);
+            }
+        }
+    }
 
-            switch(tag) {
+    void NFAMachine::advanceCharForSingleStates(RegexChar c, const NFAState& ostates, NFAEpsilonWorkSet& workset, NFAState& nstates) const
+    {
+        for(auto iter = ostates.singlestates.cbegin(); iter != ostates.singlestates.cend(); ++iter) {
+            //states without char transitions (Accept) just drop the token
+            if(this->program.charTest(iter->cstate, c)) {
+                this->addNextSingleState(nstates, workset, iter->toNextState(this->program.follows[iter->cstate]));
+            }
+        }
+    }
+        
+    void NFAMachine::advanceCharForFullStates(RegexChar c, const NFAState& ostates, NFAEpsilonWorkSet& workset, NFAState& nstates) const
+    {
+        for(auto iter = ostates.fullstates.cbegin(); iter != ostates.fullstates.cend(); ++iter) {
+            //states without char transitions (Accept) just drop the token
+            if(this->program.charTest(iter->cstate, c)) {
+                this->addNextFullState(nstates, workset, iter->toNextState(this->program.follows[iter->cstate]));
+            }
+        }
+    }
+
+    void NFAMachine::advanceEpsilonForSingleStates(NFAEpsilonFixpointSet& fixpoint, NFAEpsilonWorkSet& workset, NFAState& nstates) const
+    {
+        while(workset.hasSingleStates()) {
+            const NFASingleStateToken stok = workset.getNextSingleState();
+
+            const StateID cs = stok.cstate;
+            switch(this->program.tags[cs]) {
                 case NFAOptTag::AnyOf: {
-                    const NFAOptAnyOf* anyof = static_cast<const NFAOptAnyOf*>(opt);
-                    for(auto iter = anyof->follows.cbegin(); iter != anyof->follows.cend(); ++iter) {
-                        this->processSimpleStateEpsilonTransition(nstates, fixpoint, workset, stok.toNextState(*iter));
+                    for(auto iter = this->program.anyofFollowsBegin(cs); iter != this->program.anyofFollowsEnd(cs); ++iter) {
+                        this->processSingleStateEpsilonTransition(nstates, fixpoint, workset, stok.toNextState(*iter));
                     }
 
                     break;
                 }
                 case NFAOptTag::Star: {
-                    const NFAOptStar* star = static_cast<const NFAOptStar*>(opt);
-                    this->processSimpleStateEpsilonTransition(nstates, fixpoint, workset, stok.toNextState(star->matchfollow));
-                    this->processSimpleStateEpsilonTransition(nstates, fixpoint, workset, stok.toNextState(star->skipfollow));
+                    this->processSingleStateEpsilonTransition(nstates, fixpoint, workset, stok.toNextState(this->program.follows[cs]));
+                    this->processSingleStateEpsilonTransition(nstates, fixpoint, workset, stok.toNextState(this->program.starSkipFollow(cs)));
 
                     break;
                 }
                 case NFAOptTag::RangeK: {
-                    const NFAOptRangeK* rngk = static_cast<const NFAOptRangeK*>(opt);
-                    nstates.singlestates.insert(NFASingleStateToken::toNextStateWithInitialize(rngk->infollow, rngk->stateid));
+                    const StateID infollow = this->program.follows[cs];
+                    const NFAProgramCounter& rngk = this->program.counter(cs);
+                    if(cs != stok.rangecount.first) {
+                        this->processFullStateEpsilonTransition(nstates, fixpoint, workset, NFAFullStateToken::toNextStateWithInitialize(infollow, stok.rangecount, cs));
 
-                    if(rngk->mink == 0) {
-                        this->processSimpleStateEpsilonTransition(nstates, fixpoint, workset, stok.toNextState(rngk->outfollow));
+                        if(rngk.mink == 0) {
+                            this->processSingleStateEpsilonTransition(nstates, fixpoint, workset, stok.toNextState(rngk.outfollow));
+                        }
+                    }
+                    else {
+                        if(stok.rangecount.second < rngk.mink) {
+                            this->processSingleStateEpsilonTransition(nstates, fixpoint, workset, stok.toNextStateWithIncrement(infollow));
+                        }
+                        else if(rngk.maxk != UINT16_MAX && stok.rangecount.second == rngk.maxk) {
+                            this->processSimpleClosureEpsilonTransition(nstates, fixpoint, workset, rngk.outfollow);
+                        }
+                        else if(rngk.maxk == UINT16_MAX) {
+                            //every count past mink of an unbounded range behaves the same so the count stops at mink (and a body that matches empty cannot count up forever)
+                            this->processSingleStateEpsilonTransition(nstates, fixpoint, workset, stok.toNextState(infollow));
+                            this->processSimpleClosureEpsilonTransition(nstates, fixpoint, workset, rngk.outfollow);
+                        }
+                        else {
+                            this->processSingleStateEpsilonTransition(nstates, fixpoint, workset, stok.toNextStateWithIncrement(infollow));
+                            this->processSimpleClosureEpsilonTransition(nstates, fixpoint, workset, rngk.outfollow);
+                        }
                     }
 
                     break;
@@ -176,49 +465,54 @@ namespace brex
         }
     }
 
-    void NFAMachine::advanceEpsilonForSingleStates(NFAEpsilonFixpointSet& fixpoint, NFAEpsilonWorkSet& workset, NFAState& nstates) const
+    void NFAMachine::advanceEpsilonForFullStates(NFAEpsilonFixpointSet& fixpoint, NFAEpsilonWorkSet& workset, NFAState& nstates) const
     {
-        while(workset.hasSingleStates()) {
-            const NFASingleStateToken stok = workset.getNextSingleState();
-
-            const NFAOpt* opt = this->nfaopts[stok.cstate];
-            const NFAOptTag tag = opt->tag;
+        while(workset.hasFullStates()) {
+            const NFAFullStateToken ftok = workset.getNextFullState();
 
-            switch(tag) {
+            const StateID cs = ftok.cstate;
+            switch(this->program.tags[cs]) {
                 case NFAOptTag::AnyOf: {
-                    const NFAOptAnyOf* anyof = static_cast<const NFAOptAnyOf*>(opt);
-                    for(auto iter = anyof->follows.cbegin(); iter != anyof->follows.cend(); ++iter) {
-                        this->processSingleStateEpsilonTransition(nstates, fixpoint, workset, stok.toNextState(*iter));
+                    for(auto iter = this->program.anyofFollowsBegin(cs); iter != this->program.anyofFollowsEnd(cs); ++iter) {
+                        this->processFullStateEpsilonTransition(nstates, fixpoint, workset, ftok.toNextState(*iter));
                     }
 
                     break;
                 }
                 case NFAOptTag::Star: {
-                    const NFAOptStar* star = static_cast<const NFAOptStar*>(opt);
-                    this->processSingleStateEpsilonTransition(nstates, fixpoint, workset, stok.toNextState(star->matchfollow));
-                    this->processSingleStateEpsilonTransition(nstates, fixpoint, workset, stok.toNextState(star->skipfollow));
+                    this->processFullStateEpsilonTransition(nstates, fixpoint, workset, ftok.toNextState(this->program.follows[cs]));
+                    this->processFullStateEpsilonTransition(nstates, fixpoint, workset, ftok.toNextState(this->program.starSkipFollow(cs)));
 
                     break;
                 }
                 case NFAOptTag::RangeK: {
-                    const NFAOptRangeK* rngk = static_cast<const NFAOptRangeK*>(opt);
-                    if(rngk->stateid != stok.rangecount.first) {
-                        this->processFullStateEpsilonTransition(nstates, fixpoint, workset, NFAFullStateToken::toNextStateWithInitialize(rngk->infollow, stok.rangecount, rngk->stateid));
+                    //ranges are well nested so a RangeK is either the innermost counter (looping back) or a new range nested inside it
+                    const StateID infollow = this->program.follows[cs];
+                    const NFAProgramCounter& rngk = this->program.counter(cs);
+                    if(cs != ftok.innerRange().first) {
+                        BREX_ASSERT(ftok.depth < NFA_MAX_RANGE_NESTING, "Range repeats nested too deeply -- should be rejected by the resolver");
+                        this->processFullStateEpsilonTransition(nstates, fixpoint, workset, ftok.toNextStateWithNestedInitialize(infollow, cs));
 
-                        if(rngk->mink == 0) {
-                            this->processSingleStateEpsilonTransition(nstates, fixpoint, workset, stok.toNextState(rngk->outfollow));
+                        if(rngk.mink == 0) {
+                            this->processFullStateEpsilonTransition(nstates, fixpoint, workset, ftok.toNextState(rngk.outfollow));
                         }
                     }
                     else {
-                        if(stok.rangecount.second < rngk->mink) {
-                            this->processSingleStateEpsilonTransition(nstates, fixpoint, workset, stok.toNextStateWithIncrement(rngk->infollow));
+                        const uint16_t count = ftok.innerRange().second;
+                        if(count < rngk.mink) {
+                            this->processFullStateEpsilonTransition(nstates, fixpoint, workset, ftok.toNextStateWithIncrement(infollow));
+                        }
+                        else if(rngk.maxk != UINT16_MAX && count == rngk.maxk) {
+                            this->processFullStateDoneRangeEpsilonTransition(nstates, fixpoint, workset, ftok, rngk.outfollow);
                         }
-                        else if(rngk->maxk != INT16_MAX && stok.rangecount.second == rngk->maxk) {
-                            this->processSimpleStateEpsilonTransition(nstates, fixpoint, workset, stok.toNextStateWithDoneRange(rngk->outfollow));
+                        else if(rngk.maxk == UINT16_MAX) {
+                            //the count of an unbounded range stops at mink (as for single tokens)
+                            this->processFullStateEpsilonTransition(nstates, fixpoint, workset, ftok.toNextState(infollow));
+                            this->processFullStateDoneRangeEpsilonTransition(nstates, fixpoint, workset, ftok, rngk.outfollow);
                         }
                         else {
-                            this->processSingleStateEpsilonTransition(nstates, fixpoint, workset, stok.toNextStateWithIncrement(rngk->infollow));
-                            this->processSimpleStateEpsilonTransition(nstates, fixpoint, workset, stok.toNextStateWithDoneRange(rngk->outfollow));
+                            this->processFullStateEpsilonTransition(nstates, fixpoint, workset, ftok.toNextStateWithIncrement(infollow));
+                            this->processFullStateDoneRangeEpsilonTransition(nstates, fixpoint, workset, ftok, rngk.outfollow);
                         }
                     }
 
@@ -231,11 +525,4 @@ namespace brex
             }
         }
     }
-
-    void NFAMachine::advanceEpsilonForFullStates(NFAEpsilonFixpointSet& fixpoint, NFAEpsilonWorkSet& workset, NFAState& nstates) const
-    {
-        while(workset.hasFullStates()) {
-            BREX_ASSERT(false, "Not implemented");
-        }
-    }
 }
@@ -2,9 +2,11 @@
 
 #include "../common.h"
 
+#include <array>
+
 namespace brex
 {
-    typedef size_t StateID;
+    typedef uint32_t StateID;
     
     uint16_t saturateNFATokenIncrement(uint16_t count);
 
@@ -67,7 +69,7 @@ namespace brex
 
         bool operator!=(const NFASingleStateToken& other) const
         {
-            return this->cstate != other.cstate && this->rangecount != other.rangecount;
+            return this->cstate != other.cstate || this->rangecount != other.rangecount;
         }
 
         static bool cmp(const NFASingleStateToken& t1, const NFASingleStateToken& t2)
@@ -104,14 +106,20 @@ namespace brex
         }
     };
 
+    //max nesting depth of range repeats -- a full token carries a fixed size tuple with a counter for each enclosing RangeK
+    #define NFA_MAX_RANGE_NESTING 4
+
     class NFAFullStateToken
     {
     public:
         StateID cstate;
-        std::vector<std::pair<StateID, uint16_t>> rangecounts;
+
+        //counters in [0, depth) from the outermost RangeK to the innermost -- unused entries are kept zeroed so tokens compare on the whole tuple
+        size_t depth;
+        std::array<std::pair<StateID, uint16_t>, NFA_MAX_RANGE_NESTING> rangecounts;
         
-        NFAFullStateToken() : cstate(0), rangecounts() {;}
-        NFAFullStateToken(StateID cstate, std::vector<std::pair<StateID, uint16_t>> rangecounts) : cstate(cstate), rangecounts(rangecounts) {;}
+        NFAFullStateToken() : cstate(0), depth(0), rangecounts() {;}
+        NFAFullStateToken(StateID cstate, size_t depth, std::array<std::pair<StateID, uint16_t>, NFA_MAX_RANGE_NESTING> rangecounts) : cstate(cstate), depth(depth), rangecounts(rangecounts) {;}
         ~NFAFullStateToken() {;}
 
         NFAFullStateToken(const NFAFullStateToken& other) = default;
@@ -122,12 +130,12 @@ namespace brex
 
         bool operator==(const NFAFullStateToken& other) const
         {
-            return this->cstate == other.cstate && std::equal(this->rangecounts.cbegin(), this->rangecounts.cend(), other.rangecounts.cbegin(), other.rangecounts.cend());
+            return this->cstate == other.cstate && this->rangecounts == other.rangecounts;
         }
 
         bool operator!=(const NFAFullStateToken& other) const
         {
-            return this->cstate != other.cstate || !std::equal(this->rangecounts.cbegin(), this->rangecounts.cend(), other.rangecounts.cbegin(), other.rangecounts.cend());
+            return this->cstate != other.cstate || this->rangecounts != other.rangecounts;
         }
 
         static bool cmp(const NFAFullStateToken& t1, const NFAFullStateToken& t2)
@@ -139,33 +147,62 @@ namespace brex
                 return false;
             }
             else {
-                return std::lexicographical_compare(t1.rangecounts.cbegin(), t1.rangecounts.cend(), t2.rangecounts.cbegin(), t2.rangecounts.cend());
+                return t1.rangecounts < t2.rangecounts;
             }
         }
 
+        inline const std::pair<StateID, uint16_t>& innerRange() const
+        {
+            return this->rangecounts[this->depth - 1];
+        }
+
         inline NFAFullStateToken toNextState(StateID next) const
         {
-            return NFAFullStateToken(next, this->rangecounts);
+            return NFAFullStateToken(next, this->depth, this->rangecounts);
         }
 
         static inline NFAFullStateToken toNextStateWithInitialize(StateID next, std::pair<StateID, uint16_t> existingrng, StateID incState)
         {
-            std::vector<std::pair<StateID, uint16_t>> newrangecounts = {existingrng, std::make_pair(incState, 1)};
-            return NFAFullStateToken(next, newrangecounts);
+            std::array<std::pair<StateID, uint16_t>, NFA_MAX_RANGE_NESTING> newrangecounts = {};
+            newrangecounts[0] = existingrng;
+            newrangecounts[1] = std::make_pair(incState, 1);
+
+            return NFAFullStateToken(next, 2, newrangecounts);
         }
 
-        inline NFAFullStateToken toNextStateWithIncrement(StateID next, StateID incState) const
+        inline NFAFullStateToken toNextStateWithNestedInitialize(StateID next, StateID incState) const
         {
-            std::vector<std::pair<StateID, uint16_t>> newrangecounts(this->rangecounts.size());
-            std::transform(this->rangecounts.cbegin(), this->rangecounts.cend(), newrangecounts.begin(), [incState](const std::pair<StateID, uint16_t>& rc) {
-                return rc.first == incState ? std::make_pair(rc.first, saturateNFATokenIncrement(rc.second)) : rc;
-            });
+            NFAFullStateToken ntok(next, this->depth + 1, this->rangecounts);
+            ntok.rangecounts[this->depth] = std::make_pair(incState, 1);
 
-            return NFAFullStateToken(next, newrangecounts);
+            return ntok;
+        }
+
+        inline NFAFullStateToken toNextStateWithIncrement(StateID next) const
+        {
+            NFAFullStateToken ntok(next, this->depth, this->rangecounts);
+            ntok.rangecounts[this->depth - 1].second = saturateNFATokenIncrement(ntok.rangecounts[this->depth - 1].second);
+
+            return ntok;
+        }
+
+        //exit the innermost range when there are (at least) 3 counters
+        inline NFAFullStateToken toNextStateWithDoneRange(StateID next) const
+        {
+            NFAFullStateToken ntok(next, this->depth - 1, this->rangecounts);
+            ntok.rangecounts[this->depth - 1] = std::make_pair(0, 0);
+
+            return ntok;
+        }
+
+        //exit the innermost range when there are exactly 2 counters
+        inline NFASingleStateToken toNextSingleStateWithDoneRange(StateID next) const
+        {
+            return NFASingleStateToken(next, this->rangecounts[0]);
         }
     };
 
-    enum class NFAOptTag
+    enum class NFAOptTag : uint8_t
     {
         Accept = 0x0,
         CharCode,
@@ -259,18 +296,412 @@ namespace brex
         virtual ~NFAOptRangeK() {;}
     };
 
+    //chars below this are tested against a bitmap in an NFAProgramRangeSet
+    #define NFA_RANGE_ASCII_LIMIT 128
+
+    //A char range test in an NFAProgram -- its ranges are [start, start + count) in the shared range array (sorted, disjoint, and with any complement already applied)
+    class NFAProgramRangeSet
+    {
+    public:
+        uint32_t start;
+        uint32_t count;
+
+        //bit c is set if the ascii char c is in the set
+        uint64_t asciimask[NFA_RANGE_ASCII_LIMIT / 64];
+    };
+
+    //The bounds and exit of a RangeK state in an NFAProgram
+    class NFAProgramCounter
+    {
+    public:
+        StateID outfollow;
+        uint16_t mink;
+        uint16_t maxk;
+    };
+
+    //The NFA as a flat struct-of-arrays program that the machine executes -- tags/follows/operands have an entry per state and variable sized data is in shared side arrays
+    class NFAProgram
+    {
+    public:
+        std::vector<NFAOptTag> tags;
+
+        //follow of a CharCode/CharRange/Dot, the match follow of a Star, the in follow of a RangeK (unused for Accept/AnyOf)
+        std::vector<StateID> follows;
+
+        //the char of a CharCode, the skip follow of a Star, the index in rangesets/counters of a CharRange/RangeK, the offset in followlists of an AnyOf
+        std::vector<uint32_t> operands;
+
+        std::vector<NFAProgramRangeSet> rangesets;
+        std::vector<SingleCharRange> ranges;
+
+        //the follows of each AnyOf stored as a count and then the states
+        std::vector<StateID> followlists;
+
+        std::vector<NFAProgramCounter> counters;
+
+        NFAProgram() : tags(), follows(), operands(), rangesets(), ranges(), followlists(), counters() {;}
+        ~NFAProgram() = default;
+
+        NFAProgram(const NFAProgram& other) = default;
+        NFAProgram(NFAProgram&& other) = default;
+
+        NFAProgram& operator=(const NFAProgram& other) = default;
+        NFAProgram& operator=(NFAProgram&& other) = default;
+
+        //lay out the states emitted by the compiler (state i is nfaopts[i]) -- the opts are not retained
+        static NFAProgram assemble(const std::vector<NFAOpt*>& nfaopts);
+
+        inline size_t size() const
+        {
+            return this->tags.size();
+        }
+
+        //bytes held by the arrays
+        size_t footprint() const
+        {
+            return (this->tags.capacity() * sizeof(NFAOptTag)) + (this->follows.capacity() * sizeof(StateID)) + (this->operands.capacity() * sizeof(uint32_t)) + (this->rangesets.capacity() * sizeof(NFAProgramRangeSet)) + (this->ranges.capacity() * sizeof(SingleCharRange)) + (this->followlists.capacity() * sizeof(StateID)) + (this->counters.capacity() * sizeof(NFAProgramCounter));
+        }
+
+        inline bool concreteTransition(StateID s) const
+        {
+            return this->tags[s] <= NFAOptTag::Dot;
+        }
+
+        //true if the CharCode/CharRange/Dot state s accepts c (false for all other states)
+        inline bool charTest(StateID s, RegexChar c) const
+        {
+            switch(this->tags[s]) {
+                case NFAOptTag::CharCode: {
+                    return this->operands[s] == c;
+                }
+                case NFAOptTag::CharRange: {
+                    const NFAProgramRangeSet& rset = this->rangesets[this->operands[s]];
+                    if(c < NFA_RANGE_ASCII_LIMIT) {
+                        return ((rset.asciimask[c / 64] >> (c % 64)) & 1) != 0;
+                    }
+
+                    //find the last range that starts at or before c
+                    auto rbegin = this->ranges.cbegin() + rset.start;
+                    auto rnext = std::upper_bound(rbegin, rbegin + rset.count, c, [](RegexChar cc, const SingleCharRange& rr) {
+                        return cc < rr.low;
+                    });
+
+                    return rnext != rbegin && c <= (rnext - 1)->high;
+                }
+                case NFAOptTag::Dot: {
+                    return true;
+                }
+                default: {
+                    return false;
+                }
+            }
+        }
+
+        inline const StateID* anyofFollowsBegin(StateID s) const
+        {
+            return this->followlists.data() + this->operands[s] + 1;
+        }
+
+        inline const StateID* anyofFollowsEnd(StateID s) const
+        {
+            return this->anyofFollowsBegin(s) + this->followlists[this->operands[s]];
+        }
+
+        inline StateID starSkipFollow(StateID s) const
+        {
+            return this->operands[s];
+        }
+
+        inline const NFAProgramCounter& counter(StateID s) const
+        {
+            return this->counters[this->operands[s]];
+        }
+    };
+
+    //A sparse set of simple states -- O(1) insert/contains/clear and dense iteration in insertion order (requires knowing the number of states in the machine)
+    class NFASimpleStateSet
+    {
+    public:
+        std::vector<StateID> dense;
+        std::vector<StateID> sparse;
+        size_t count;
+
+        NFASimpleStateSet() : dense(), sparse(), count(0) {;}
+        NFASimpleStateSet(size_t statecount) : dense(statecount, 0), sparse(statecount, 0), count(0) {;}
+        ~NFASimpleStateSet() {;}
+
+        NFASimpleStateSet(const NFASimpleStateSet& other) = default;
+        NFASimpleStateSet(NFASimpleStateSet&& other) = default;
+
+        NFASimpleStateSet& operator=(const NFASimpleStateSet& other) = default;
+        NFASimpleStateSet& operator=(NFASimpleStateSet&& other) = default;
+
+        void resize(size_t statecount)
+        {
+            if(this->dense.size() < statecount) {
+                this->dense.resize(statecount, 0);
+                this->sparse.resize(statecount, 0);
+            }
+            this->count = 0;
+        }
+
+        inline size_t size() const { return this->count; }
+        inline bool empty() const { return this->count == 0; }
+        inline void clear() { this->count = 0; }
+
+        inline bool contains(StateID s) const
+        {
+            const StateID idx = this->sparse[s];
+            return idx < this->count && this->dense[idx] == s;
+        }
+
+        inline void insert(StateID s)
+        {
+            if(!this->contains(s)) {
+                this->sparse[s] = this->count;
+                this->dense[this->count] = s;
+                this->count++;
+            }
+        }
+
+        inline std::vector<StateID>::const_iterator cbegin() const { return this->dense.cbegin(); }
+        inline std::vector<StateID>::const_iterator cend() const { return this->dense.cbegin() + this->count; }
+    };
+
+    //A set of counter carrying tokens kept as a sorted vector -- storage is retained across clears so steady state stepping does not allocate
+    template <typename TToken>
+    class NFATokenSet
+    {
+    public:
+        std::vector<TToken> tokens;
+
+        NFATokenSet() : tokens() {;}
+        ~NFATokenSet() {;}
+
+        NFATokenSet(const NFATokenSet& other) = default;
+        NFATokenSet(NFATokenSet&& other) = default;
+
+        NFATokenSet& operator=(const NFATokenSet& other) = default;
+        NFATokenSet& operator=(NFATokenSet&& other) = default;
+
+        inline size_t size() const { return this->tokens.size(); }
+        inline bool empty() const { return this->tokens.empty(); }
+        inline void clear() { this->tokens.clear(); }
+
+        inline bool contains(const TToken& t) const
+        {
+            return std::binary_search(this->tokens.cbegin(), this->tokens.cend(), t, TToken::cmp);
+        }
+
+        inline void insert(const TToken& t)
+        {
+            //tokens are mostly generated in order so check the back first
+            if(this->tokens.empty() || TToken::cmp(this->tokens.back(), t)) {
+                this->tokens.push_back(t);
+                return;
+            }
+
+            auto pos = std::lower_bound(this->tokens.begin(), this->tokens.end(), t, TToken::cmp);
+            if(pos == this->tokens.end() || *pos != t) {
+                this->tokens.insert(pos, t);
+            }
+        }
+
+        //add all the tokens of other -- both are sorted so this is one merge pass
+        void insertAll(const NFATokenSet& other)
+        {
+            const size_t count = this->tokens.size();
+            this->tokens.insert(this->tokens.end(), other.tokens.cbegin(), other.tokens.cend());
+            std::inplace_merge(this->tokens.begin(), this->tokens.begin() + count, this->tokens.end(), TToken::cmp);
+            this->tokens.erase(std::unique(this->tokens.begin(), this->tokens.end()), this->tokens.end());
+        }
+
+        //true if every token of other is also here -- one pass over both sorted sets
+        inline bool containsAll(const NFATokenSet& other) const
+        {
+            return std::includes(this->tokens.cbegin(), this->tokens.cend(), other.tokens.cbegin(), other.tokens.cend(), TToken::cmp);
+        }
+
+        inline TToken pop()
+        {
+            TToken t = this->tokens.back();
+            this->tokens.pop_back();
+
+            return t;
+        }
+
+        inline typename std::vector<TToken>::const_iterator cbegin() const { return this->tokens.cbegin(); }
+        inline typename std::vector<TToken>::const_iterator cend() const { return this->tokens.cend(); }
+    };
+
+    //no counting set for the RangeK
+    #define NFA_NO_COUNTING_SET UINT32_MAX
+
+    //A RangeK whose body is a single char test that loops straight back to it -- all of its tokens are at the body state and only differ in their count so they are kept as a bit-vector of counts
+    class NFACountingSetInfo
+    {
+    public:
+        StateID rangek;
+        StateID body;
+        StateID outfollow;
+        uint16_t mink;
+
+        //largest count tracked -- maxk or for an unbounded range max(mink, 1) where all larger counts are merged (saturating)
+        uint16_t limit;
+        bool saturating;
+
+        //bit i of the words [wordoffset, wordoffset + wordcount) is set if there is a token with count i
+        uint32_t wordoffset;
+        uint32_t wordcount;
+    };
+
+    //The counting sets of a machine -- stepping all the counters of a set is a shift of its (live) words
+    class NFACountingSets
+    {
+    public:
+        std::vector<uint64_t> words;
+
+        //words [0, livewords) of each set are valid (and the last one is non-zero) -- the others may hold stale values
+        std::vector<uint32_t> livewords;
+
+        NFACountingSets() : words(), livewords() {;}
+        ~NFACountingSets() {;}
+
+        NFACountingSets(const NFACountingSets& other) = default;
+        NFACountingSets(NFACountingSets&& other) = default;
+
+        NFACountingSets& operator=(const NFACountingSets& other) = default;
+        NFACountingSets& operator=(NFACountingSets&& other) = default;
+
+        void resize(size_t setcount, size_t wordcount)
+        {
+            if(this->words.size() < wordcount) {
+                this->words.resize(wordcount, 0);
+            }
+            this->livewords.assign(setcount, 0);
+        }
+
+        inline void clear()
+        {
+            std::fill(this->livewords.begin(), this->livewords.end(), 0);
+        }
+
+        inline bool empty(size_t cset) const
+        {
+            return this->livewords[cset] == 0;
+        }
+
+        inline bool allEmpty() const
+        {
+            return std::all_of(this->livewords.cbegin(), this->livewords.cend(), [](uint32_t lw) { return lw == 0; });
+        }
+
+        //a new token entering the range with count 1
+        inline void insertInitial(size_t cset, const NFACountingSetInfo& info)
+        {
+            this->extendLive(cset, info, 1);
+            this->words[info.wordoffset] |= 2;
+        }
+
+        //true if there is a token with count >= k
+        inline bool anyAtLeast(size_t cset, const NFACountingSetInfo& info, size_t k) const
+        {
+            const uint32_t live = this->livewords[cset];
+            if((k / 64) >= live) {
+                return false;
+            }
+
+            const uint64_t* cwords = this->words.data() + info.wordoffset;
+            return (cwords[k / 64] >> (k % 64)) != 0 || (k / 64) + 1 < live;
+        }
+
+        //add all the tokens of cset in osets with their counts incremented -- dropping counts over the limit (or merging them into it when saturating)
+        void addIncremented(size_t cset, const NFACountingSetInfo& info, const NFACountingSets& osets)
+        {
+            const uint32_t olive = osets.livewords[cset];
+            const uint64_t* owords = osets.words.data() + info.wordoffset;
+
+            const uint32_t nlive = std::min(olive + 1, info.wordcount);
+            this->extendLive(cset, info, nlive);
+
+            uint64_t* nwords = this->words.data() + info.wordoffset;
+            for(uint32_t i = 0; i < nlive; ++i) {
+                const uint64_t low = (i < olive) ? (owords[i] << 1) : 0;
+                const uint64_t carry = (i != 0 && i - 1 < olive) ? (owords[i - 1] >> 63) : 0;
+                nwords[i] |= (low | carry);
+            }
+
+            //bits above the limit are dropped -- for a saturating range count limit + 1 is merged into count limit
+            const uint32_t lword = info.limit / 64;
+            const uint64_t lbit = (uint64_t)1 << (info.limit % 64);
+            if(lword < nlive) {
+                if(info.saturating && lword < olive && (owords[lword] & lbit) != 0) {
+                    nwords[lword] |= lbit;
+                }
+                nwords[lword] &= (lbit | (lbit - 1));
+            }
+
+            while(this->livewords[cset] != 0 && nwords[this->livewords[cset] - 1] == 0) {
+                this->livewords[cset]--;
+            }
+        }
+
+        //add all the tokens of cset in osets (keeping the ones already here)
+        void addAll(size_t cset, const NFACountingSetInfo& info, const NFACountingSets& osets)
+        {
+            const uint32_t olive = osets.livewords[cset];
+            this->extendLive(cset, info, olive);
+
+            const uint64_t* owords = osets.words.data() + info.wordoffset;
+            uint64_t* nwords = this->words.data() + info.wordoffset;
+            for(uint32_t i = 0; i < olive; ++i) {
+                nwords[i] |= owords[i];
+            }
+        }
+
+        //true if every token of cset in osets is also here
+        bool containsAll(size_t cset, const NFACountingSetInfo& info, const NFACountingSets& osets) const
+        {
+            const uint32_t olive = osets.livewords[cset];
+            const uint32_t live = this->livewords[cset];
+
+            const uint64_t* owords = osets.words.data() + info.wordoffset;
+            const uint64_t* cwords = this->words.data() + info.wordoffset;
+            for(uint32_t i = 0; i < olive; ++i) {
+                if((owords[i] & ~(i < live ? cwords[i] : 0)) != 0) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+    private:
+        inline void extendLive(size_t cset, const NFACountingSetInfo& info, uint32_t live)
+        {
+            while(this->livewords[cset] < live) {
+                this->words[info.wordoffset + this->livewords[cset]] = 0;
+                this->livewords[cset]++;
+            }
+        }
+    };
+
     class NFAState
     {
     public:
-        typedef std::set<NFASimpleStateToken, decltype(&NFASimpleStateToken::cmp)> TSimpleStates;
-        typedef std::set<NFASingleStateToken, decltype(&NFASingleStateToken::cmp)> TSingleStates;
-        typedef std::set<NFAFullStateToken, decltype(&NFAFullStateToken::cmp)> TFullStates;
+        typedef NFASimpleStateSet TSimpleStates;
+        typedef NFATokenSet<NFASingleStateToken> TSingleStates;
+        typedef NFATokenSet<NFAFullStateToken> TFullStates;
 
         TSimpleStates simplestates;
         TSingleStates singlestates;
         TFullStates fullstates;
+        NFACountingSets countingsets;
+
+        //true if a simple token is in a universal state
+        bool universal;
 
-        NFAState() : simplestates(&NFASimpleStateToken::cmp), singlestates(&NFASingleStateToken::cmp), fullstates(&NFAFullStateToken::cmp) {;}
+        NFAState() : simplestates(), singlestates(), fullstates(), countingsets(), universal(false) {;}
+        NFAState(size_t statecount) : simplestates(statecount), singlestates(), fullstates(), countingsets(), universal(false) {;}
         ~NFAState() {;}
 
         NFAState(const NFAState& other) = default;
@@ -284,50 +715,128 @@ namespace brex
             return this->simplestates.size() + this->singlestates.size() + this->fullstates.size();
         }
 
-        void intitialize() {
-            this->simplestates.clear();
+        void intitialize(size_t statecount, size_t countingsetcount = 0, size_t countingwordcount = 0) {
+            this->simplestates.resize(statecount);
             this->singlestates.clear();
             this->fullstates.clear();
+            this->countingsets.resize(countingsetcount, countingwordcount);
+            this->universal = false;
         }
 
         void reset() {
             this->simplestates.clear();
             this->singlestates.clear();
             this->fullstates.clear();
+            this->countingsets.clear();
+            this->universal = false;
+        }
+
+        //add all the tokens of ostates (for a machine with the counting sets csets)
+        void addAll(const NFAState& ostates, const std::vector<NFACountingSetInfo>& csets)
+        {
+            for(auto iter = ostates.simplestates.cbegin(); iter != ostates.simplestates.cend(); ++iter) {
+                this->simplestates.insert(*iter);
+            }
+            this->singlestates.insertAll(ostates.singlestates);
+            this->fullstates.insertAll(ostates.fullstates);
+            for(size_t i = 0; i < csets.size(); ++i) {
+                this->countingsets.addAll(i, csets[i], ostates.countingsets);
+            }
+            this->universal |= ostates.universal;
+        }
+
+        //true if every token of ostates is also here -- so stepping ostates can never accept anywhere that stepping these tokens does not
+        bool containsAll(const NFAState& ostates, const std::vector<NFACountingSetInfo>& csets) const
+        {
+            bool contained = std::all_of(ostates.simplestates.cbegin(), ostates.simplestates.cend(), [this](StateID s) { return this->simplestates.contains(s); });
+            contained = contained && this->singlestates.containsAll(ostates.singlestates);
+            contained = contained && this->fullstates.containsAll(ostates.fullstates);
+            for(size_t i = 0; contained && i < csets.size(); ++i) {
+                contained = this->countingsets.containsAll(i, csets[i], ostates.countingsets);
+            }
+            return contained;
+        }
+
+        void swap(NFAState& other)
+        {
+            std::swap(this->simplestates, other.simplestates);
+            std::swap(this->singlestates, other.singlestates);
+            std::swap(this->fullstates, other.fullstates);
+            std::swap(this->countingsets, other.countingsets);
+            std::swap(this->universal, other.universal);
+        }
+    };
+
+    //The state of a leftmost search on a machine without counters -- each simple state carries the tag (input position) of the thread that reached it first
+    //Threads are stepped in priority order and the first to reach a state keeps it so the dense order of the states is also the priority order
+    class NFATaggedState
+    {
+    public:
+        NFASimpleStateSet states;
+        std::vector<int64_t> tags;
+
+        NFATaggedState() : states(), tags() {;}
+        ~NFATaggedState() {;}
+
+        NFATaggedState(const NFATaggedState& other) = default;
+        NFATaggedState(NFATaggedState&& other) = default;
+
+        NFATaggedState& operator=(const NFATaggedState& other) = default;
+        NFATaggedState& operator=(NFATaggedState&& other) = default;
+
+        void intitialize(size_t statecount)
+        {
+            this->states.resize(statecount);
+            if(this->tags.size() < statecount) {
+                this->tags.resize(statecount, 0);
+            }
+        }
+
+        inline void insert(StateID s, int64_t tag)
+        {
+            if(!this->states.contains(s)) {
+                this->states.insert(s);
+                this->tags[s] = tag;
+            }
+        }
+
+        //drop the threads that started after tag (which are the tail of the priority order) -- forward searches start threads at increasing positions and reverse searches at decreasing ones
+        template <bool isforward>
+        void dropAfter(int64_t tag)
+        {
+            while(this->states.count != 0 && (isforward ? (this->tags[this->states.dense[this->states.count - 1]] > tag) : (this->tags[this->states.dense[this->states.count - 1]] < tag))) {
+                this->states.count--;
+            }
+        }
+
+        void swap(NFATaggedState& other)
+        {
+            std::swap(this->states, other.states);
+            std::swap(this->tags, other.tags);
         }
     };
 
     class NFAEpsilonWorkSet
     {
     public:
-        typedef std::set<NFASimpleStateToken, decltype(&NFASimpleStateToken::cmp)> TSimpleStates;
-        typedef std::set<NFASingleStateToken, decltype(&NFASingleStateToken::cmp)> TSingleStates;
-        typedef std::set<NFAFullStateToken, decltype(&NFAFullStateToken::cmp)> TFullStates;
+        typedef NFATokenSet<NFASingleStateToken> TSingleStates;
+        typedef NFATokenSet<NFAFullStateToken> TFullStates;
 
-        TSimpleStates simplestates;
         TSingleStates singlestates;
         TFullStates fullstates;
 
-        NFAEpsilonWorkSet() : simplestates(&NFASimpleStateToken::cmp), singlestates(&NFASingleStateToken::cmp), fullstates(&NFAFullStateToken::cmp) {;}
+        NFAEpsilonWorkSet() : singlestates(), fullstates() {;}
         ~NFAEpsilonWorkSet() {;}
 
-        bool done() const
+        void reset()
         {
-            return this->simplestates.empty() && this->singlestates.empty() && this->fullstates.empty();
-        }
-
-        bool hasSimpleStates() const 
-        { 
-            return !this->simplestates.empty(); 
+            this->singlestates.clear();
+            this->fullstates.clear();
         }
-        NFASimpleStateToken getNextSimpleState() 
-        { 
-            auto it = this->simplestates.begin();
-            
-            NFASimpleStateToken t = *it;
-            this->simplestates.erase(it);
 
-            return t;
+        bool done() const
+        {
+            return this->singlestates.empty() && this->fullstates.empty();
         }
 
         bool hasSingleStates() const 
@@ -336,12 +845,7 @@ namespace brex
         }
         NFASingleStateToken getNextSingleState() 
         { 
-            auto it = this->singlestates.begin();
-            
-            NFASingleStateToken t = *it;
-            this->singlestates.erase(it);
-
-            return t;
+            return this->singlestates.pop();
         }
 
         bool hasFullStates() const 
@@ -350,47 +854,49 @@ namespace brex
         }
         NFAFullStateToken getNextFullState() 
         { 
-            auto it = this->fullstates.begin();
-            
-            NFAFullStateToken t = *it;
-            this->fullstates.erase(it);
-
-            return t;
+            return this->fullstates.pop();
         }
     };
 
     class NFAEpsilonFixpointSet
     {
     public:
-        typedef std::set<NFASimpleStateToken, decltype(&NFASimpleStateToken::cmp)> TSimpleStates;
-        typedef std::set<NFASingleStateToken, decltype(&NFASingleStateToken::cmp)> TSingleStates;
-        typedef std::set<NFAFullStateToken, decltype(&NFAFullStateToken::cmp)> TFullStates;
+        typedef NFATokenSet<NFASingleStateToken> TSingleStates;
+        typedef NFATokenSet<NFAFullStateToken> TFullStates;
 
-        TSimpleStates simplestates;
         TSingleStates singlestates;
         TFullStates fullstates;
 
-        NFAEpsilonFixpointSet() : simplestates(&NFASimpleStateToken::cmp), singlestates(&NFASingleStateToken::cmp), fullstates(&NFAFullStateToken::cmp) {;}
+        NFAEpsilonFixpointSet() : singlestates(), fullstates() {;}
         ~NFAEpsilonFixpointSet() {;}
 
-        NFAEpsilonFixpointSet(const NFAEpsilonWorkSet& iworkset) : simplestates(iworkset.simplestates), singlestates(iworkset.singlestates), fullstates(iworkset.fullstates) {;}
+        //reset the fixpoint to contain exactly the (initial) contents of the workset
+        void intitialize(const NFAEpsilonWorkSet& iworkset)
+        {
+            this->singlestates = iworkset.singlestates;
+            this->fullstates = iworkset.fullstates;
+        }
+    };
+
+    //The (precomputed) set of states reachable from a state by simple token epsilon moves (AnyOf, Star, and the skip edge of a RangeK with mink == 0)
+    //It is stored in a shared array as [start, start + concretecount) for the concrete states that a simple token lands in followed by rangekcount RangeK states that are entered (each starts a counter carrying token)
+    class NFAEpsilonClosure
+    {
+    public:
+        uint32_t start;
+        uint32_t concretecount;
+        uint32_t rangekcount;
+
+        //true if one of the concrete states is universal -- so every extension of the input is accepted
+        bool universal;
     };
 
     class NFAMachine
     {
     private:
-        void addNextSimpleState(NFAState& nstates, NFAEpsilonWorkSet& workset, const NFASimpleStateToken& t) const
-        {
-            if(this->nfaopts[t.cstate]->concreteTransition()) {
-                nstates.simplestates.insert(t);
-            }
-            else {
-                workset.simplestates.insert(t);
-            }
-        }
         void addNextSingleState(NFAState& nstates, NFAEpsilonWorkSet& workset, const NFASingleStateToken& t) const
         {
-            if(this->nfaopts[t.cstate]->concreteTransition()) {
+            if(this->program.concreteTransition(t.cstate)) {
                 nstates.singlestates.insert(t);
             }
             else {
@@ -399,7 +905,7 @@ namespace brex
         }
         void addNextFullState(NFAState& nstates, NFAEpsilonWorkSet& workset, const NFAFullStateToken& t) const
         {
-            if(this->nfaopts[t.cstate]->concreteTransition()) {
+            if(this->program.concreteTransition(t.cstate)) {
                 nstates.fullstates.insert(t);
             }
             else {
@@ -407,21 +913,53 @@ namespace brex
             }
         }
 
-        void processSimpleStateEpsilonTransition(NFAState& nstates, NFAEpsilonFixpointSet& fixpoint, NFAEpsilonWorkSet& workset, const NFASimpleStateToken& t) const
+        //a simple token entering state s during a char step lands in all of the states in the closure of s
+        void addNextSimpleClosure(NFAState& nstates, NFAEpsilonWorkSet& workset, StateID s) const
         {
-            if(this->nfaopts[t.cstate]->concreteTransition()) {
-                nstates.simplestates.insert(t);
+            const NFAEpsilonClosure& closure = this->closures[s];
+            const StateID* concretes = this->closurestates.data() + closure.start;
+            for(uint32_t i = 0; i < closure.concretecount; ++i) {
+                nstates.simplestates.insert(concretes[i]);
             }
-            else {
-                if(!fixpoint.simplestates.contains(t)) {
-                    fixpoint.simplestates.insert(t);
-                    workset.simplestates.insert(t);
+            nstates.universal |= closure.universal;
+
+            const StateID* rangeks = concretes + closure.concretecount;
+            for(uint32_t i = 0; i < closure.rangekcount; ++i) {
+                const uint32_t cset = this->countingsetindex[rangeks[i]];
+                if(cset != NFA_NO_COUNTING_SET) {
+                    nstates.countingsets.insertInitial(cset, this->countingsets[cset]);
+                }
+                else {
+                    this->addNextSingleState(nstates, workset, NFASingleStateToken::toNextStateWithInitialize(this->program.follows[rangeks[i]], rangeks[i]));
                 }
             }
         }
+
+        //a simple token entering state s during the epsilon pass (e.g. exiting a RangeK)
+        void processSimpleClosureEpsilonTransition(NFAState& nstates, NFAEpsilonFixpointSet& fixpoint, NFAEpsilonWorkSet& workset, StateID s) const
+        {
+            const NFAEpsilonClosure& closure = this->closures[s];
+            const StateID* concretes = this->closurestates.data() + closure.start;
+            for(uint32_t i = 0; i < closure.concretecount; ++i) {
+                nstates.simplestates.insert(concretes[i]);
+            }
+            nstates.universal |= closure.universal;
+
+            const StateID* rangeks = concretes + closure.concretecount;
+            for(uint32_t i = 0; i < closure.rangekcount; ++i) {
+                const uint32_t cset = this->countingsetindex[rangeks[i]];
+                if(cset != NFA_NO_COUNTING_SET) {
+                    nstates.countingsets.insertInitial(cset, this->countingsets[cset]);
+                }
+                else {
+                    this->processSingleStateEpsilonTransition(nstates, fixpoint, workset, NFASingleStateToken::toNextStateWithInitialize(this->program.follows[rangeks[i]], rangeks[i]));
+                }
+            }
+        }
+
         void processSingleStateEpsilonTransition(NFAState& nstates, NFAEpsilonFixpointSet& fixpoint, NFAEpsilonWorkSet& workset, const NFASingleStateToken& t) const
         {
-            if(this->nfaopts[t.cstate]->concreteTransition()) {
+            if(this->program.concreteTransition(t.cstate)) {
                 nstates.singlestates.insert(t);
             }
             else {
@@ -433,7 +971,7 @@ namespace brex
         }
         void processFullStateEpsilonTransition(NFAState& nstates, NFAEpsilonFixpointSet& fixpoint, NFAEpsilonWorkSet& workset, const NFAFullStateToken& t) const
         {
-            if(this->nfaopts[t.cstate]->concreteTransition()) {
+            if(this->program.concreteTransition(t.cstate)) {
                 nstates.fullstates.insert(t);
             }
             else {
@@ -444,32 +982,98 @@ namespace brex
             }
         }
 
-        //process a single char and compute the new state
+        //a full token leaving its innermost range drops back to a single token when only the outermost counter is left
+        void processFullStateDoneRangeEpsilonTransition(NFAState& nstates, NFAEpsilonFixpointSet& fixpoint, NFAEpsilonWorkSet& workset, const NFAFullStateToken& t, StateID next) const
+        {
+            if(t.depth == 2) {
+                this->processSingleStateEpsilonTransition(nstates, fixpoint, workset, t.toNextSingleStateWithDoneRange(next));
+            }
+            else {
+                this->processFullStateEpsilonTransition(nstates, fixpoint, workset, t.toNextStateWithDoneRange(next));
+            }
+        }
+
+        //process a single char and compute the new state -- counting sets go first as the others may add new tokens to them
+        void advanceCharForCountingSets(RegexChar c, const NFAState& ostates, NFAEpsilonWorkSet& workset, NFAState& nstates) const;
         void advanceCharForSimpleStates(RegexChar c, const NFAState& ostates, NFAEpsilonWorkSet& workset, NFAState& nstates) const;
         void advanceCharForSingleStates(RegexChar c, const NFAState& ostates, NFAEpsilonWorkSet& workset, NFAState& nstates) const;
         void advanceCharForFullStates(RegexChar c, const NFAState& ostates, NFAEpsilonWorkSet& workset, NFAState& nstates) const;
 
-        //process all the epsilon transitions and compute the new state
-        void advanceEpsilonForSimpleStates(NFAEpsilonFixpointSet& fixpoint, NFAEpsilonWorkSet& workset, NFAState& nstates) const;
+        //process all the epsilon transitions and compute the new state -- simple tokens use the precomputed closures
         void advanceEpsilonForSingleStates(NFAEpsilonFixpointSet& fixpoint, NFAEpsilonWorkSet& workset, NFAState& nstates) const;
         void advanceEpsilonForFullStates(NFAEpsilonFixpointSet& fixpoint, NFAEpsilonWorkSet& workset, NFAState& nstates) const;
 
+        void computeLiveStates();
+        void computeUniversalStates();
+
+        void computeEpsilonClosure(StateID s, NFAEpsilonClosure& closure);
+        void computeEpsilonClosures();
+
+        void computeCountingSets();
+
+        //a tagged thread entering state s lands in all of the states in the closure of s (there are no RangeKs in machines that run tagged)
+        void addTaggedClosure(NFATaggedState& nstates, StateID s, int64_t tag) const
+        {
+            const NFAEpsilonClosure& closure = this->closures[s];
+            const StateID* concretes = this->closurestates.data() + closure.start;
+            for(uint32_t i = 0; i < closure.concretecount; ++i) {
+                nstates.insert(concretes[i], tag);
+            }
+        }
+
     public:
         const StateID startstate;
         const StateID acceptstate;
 
-        const std::vector<NFAOpt*> nfaopts;
+        const NFAProgram program;
         NFASimpleStateToken acceptStateRepr;
 
-        NFAMachine(StateID startstate, StateID acceptstate, std::vector<NFAOpt*> nfaopts) : startstate(startstate), acceptstate(acceptstate), nfaopts(nfaopts), acceptStateRepr(acceptstate) { ; }
+        //states that can reach the accept state (tokens in other states are dropped when closures are built) and the universal states -- concrete states that accept any char and whose follow closure includes the accept state and another universal state
+        std::vector<bool> livestates;
+        std::vector<bool> universalstates;
+        bool hasuniversal;
+
+        //closure for each state that a simple token can enter (the start state, follows of concrete states, and RangeK exits) -- empty for the others
+        std::vector<NFAEpsilonClosure> closures;
+        std::vector<StateID> closurestates;
+
+        //the RangeKs that are run as counting sets, the index of the set for each state (NFA_NO_COUNTING_SET if none), and the total words for their bit-vectors
+        std::vector<NFACountingSetInfo> countingsets;
+        std::vector<uint32_t> countingsetindex;
+        size_t countingwordcount;
+
+        //the program is moved in -- it is the bulk of the machine so the compiler does not keep a second copy of it
+        NFAMachine(StateID startstate, StateID acceptstate, NFAProgram&& program) : startstate(startstate), acceptstate(acceptstate), program(std::move(program)), acceptStateRepr(acceptstate), livestates(), universalstates(), hasuniversal(false), closures(), closurestates(), countingsets(), countingsetindex(), countingwordcount(0)
+        { 
+            this->computeLiveStates();
+            this->computeCountingSets();
+            this->computeEpsilonClosures();
+            this->computeUniversalStates();
+        }
         ~NFAMachine() = default;
 
+        //bytes held by the program and the tables computed from it
+        size_t footprint() const
+        {
+            return this->program.footprint() + ((this->livestates.capacity() + this->universalstates.capacity()) / 8) + (this->closures.capacity() * sizeof(NFAEpsilonClosure)) + (this->closurestates.capacity() * sizeof(StateID)) + (this->countingsets.capacity() * sizeof(NFACountingSetInfo)) + (this->countingsetindex.capacity() * sizeof(uint32_t));
+        }
+
         //true if the machine has accepted or all paths are rejected
         bool inAccepted(const NFAState& ostates) const;
         bool allRejected(const NFAState& ostates) const;
 
+        //true if the start state is accepting
+        bool acceptsEmpty() const;
+
+        //true if every extension of the input is accepted (so the machine does not need to be stepped further)
+        inline bool allAccepted(const NFAState& ostates) const
+        {
+            return ostates.universal;
+        }
+
         void advanceChar(RegexChar c, const NFAState& ostates, NFAEpsilonWorkSet& workset, NFAState& nstates) const
         {
+            this->advanceCharForCountingSets(c, ostates, workset, nstates);
             this->advanceCharForSimpleStates(c, ostates, workset, nstates);
             this->advanceCharForSingleStates(c, ostates, workset, nstates);
             this->advanceCharForFullStates(c, ostates, workset, nstates);
@@ -478,10 +1082,6 @@ namespace brex
         void advanceEpsilon(NFAEpsilonFixpointSet& fixpoint, NFAEpsilonWorkSet& workset, NFAState& nstates) const
         {
             while(!workset.done()) {
-                if(workset.hasSimpleStates()) {
-                    this->advanceEpsilonForSimpleStates(fixpoint, workset, nstates);
-                }
-
                 if(workset.hasSingleStates()) {
                     this->advanceEpsilonForSingleStates(fixpoint, workset, nstates);
                 }
@@ -492,30 +1092,70 @@ namespace brex
             }
         }
 
-        void intitializeMachine(NFAState& nstates) const
+        //compute the initial state of the machine into nstates -- workset and fixpoint are caller owned scratch space
+        void intitializeMachine(NFAState& nstates, NFAEpsilonWorkSet& workset, NFAEpsilonFixpointSet& fixpoint) const
         {
-            nstates.intitialize();
-            NFAEpsilonWorkSet workset;
-            this->addNextSimpleState(nstates, workset, NFASimpleStateToken{this->startstate});
+            nstates.intitialize(this->program.size(), this->countingsets.size(), this->countingwordcount);
+            workset.reset();
+            this->addNextSimpleClosure(nstates, workset, this->startstate);
 
-            NFAEpsilonFixpointSet fixpoint(workset);
+            fixpoint.intitialize(workset);
             while(!workset.done()) {
                 this->advanceEpsilon(fixpoint, workset, nstates);
             }
         }
 
-        NFAState stepMachine(RegexChar c, const NFAState& ostates) const
+        //tagged leftmost searches track where each thread started so they can only run on machines without counters (others run a group of states per start)
+        inline bool canRunTagged() const
+        {
+            return this->program.counters.empty();
+        }
+
+        //compute the initial state of a leftmost search with a thread tagged with tag
+        void intitializeTagged(NFATaggedState& nstates, int64_t tag) const
+        {
+            nstates.intitialize(this->program.size());
+            this->addTaggedClosure(nstates, this->startstate, tag);
+        }
+
+        //add a new (lowest priority) thread tagged with tag at the start state
+        void injectTagged(NFATaggedState& nstates, int64_t tag) const
+        {
+            this->addTaggedClosure(nstates, this->startstate, tag);
+        }
+
+        //step the threads in ostates on c into nstates (which must not alias ostates) in priority order
+        void stepTagged(RegexChar c, const NFATaggedState& ostates, NFATaggedState& nstates) const
+        {
+            nstates.intitialize(this->program.size());
+            for(auto iter = ostates.states.cbegin(); iter != ostates.states.cend(); ++iter) {
+                if(this->program.charTest(*iter, c)) {
+                    this->addTaggedClosure(nstates, this->program.follows[*iter], ostates.tags[*iter]);
+                }
+            }
+        }
+
+        inline bool inAcceptedTagged(const NFATaggedState& ostates) const
+        {
+            return ostates.states.contains(this->acceptstate);
+        }
+
+        inline int64_t acceptedTag(const NFATaggedState& ostates) const
         {
-            NFAState nstates;
-            NFAEpsilonWorkSet workset;
+            return ostates.tags[this->acceptstate];
+        }
+
+        //step the machine on c from ostates into nstates (which must not alias ostates) -- workset and fixpoint are caller owned scratch space
+        void stepMachine(RegexChar c, const NFAState& ostates, NFAState& nstates, NFAEpsilonWorkSet& workset, NFAEpsilonFixpointSet& fixpoint) const
+        {
+            nstates.intitialize(this->program.size(), this->countingsets.size(), this->countingwordcount);
+            workset.reset();
             this->advanceChar(c, ostates, workset, nstates);
 
-            NFAEpsilonFixpointSet fixpoint(workset);
+            fixpoint.intitialize(workset);
             while(!workset.done()) {
                 this->advanceEpsilon(fixpoint, workset, nstates);
             }
-
-            return nstates;
         }
     };
 }
\ No newline at end of file
@@ -0,0 +1,260 @@
+#include "nfa_optimizer.h"
+
+#include <algorithm>
+
+namespace brex
+{
+    std::vector<StateID> NFAOptimizer::followsOf(const NFAOpt* opt)
+    {
+        switch(opt->tag) {
+            case NFAOptTag::CharCode: {
+                return { static_cast<const NFAOptCharCode*>(opt)->follow };
+            }
+            case NFAOptTag::CharRange: {
+                return { static_cast<const NFAOptRange*>(opt)->follow };
+            }
+            case NFAOptTag::Dot: {
+                return { static_cast<const NFAOptDot*>(opt)->follow };
+            }
+            case NFAOptTag::AnyOf: {
+                return static_cast<const NFAOptAnyOf*>(opt)->follows;
+            }
+            case NFAOptTag::Star: {
+                const NFAOptStar* star = static_cast<const NFAOptStar*>(opt);
+                return { star->matchfollow, star->skipfollow };
+            }
+            case NFAOptTag::RangeK: {
+                const NFAOptRangeK* rngk = static_cast<const NFAOptRangeK*>(opt);
+                return { rngk->infollow, rngk->outfollow };
+            }
+            default: {
+                return {};
+            }
+        }
+    }
+
+    NFAOpt* NFAOptimizer::remapOpt(const NFAOpt* opt, StateID nid, const std::vector<StateID>& fmap)
+    {
+        switch(opt->tag) {
+            case NFAOptTag::CharCode: {
+                const NFAOptCharCode* cc = static_cast<const NFAOptCharCode*>(opt);
+                return new NFAOptCharCode(nid, cc->c, fmap[cc->follow]);
+            }
+            case NFAOptTag::CharRange: {
+                const NFAOptRange* range = static_cast<const NFAOptRange*>(opt);
+                return new NFAOptRange(nid, range->compliment, range->ranges, fmap[range->follow]);
+            }
+            case NFAOptTag::Dot: {
+                return new NFAOptDot(nid, fmap[static_cast<const NFAOptDot*>(opt)->follow]);
+            }
+            case NFAOptTag::AnyOf: {
+                const NFAOptAnyOf* anyof = static_cast<const NFAOptAnyOf*>(opt);
+
+                std::vector<StateID> follows;
+                for(auto iter = anyof->follows.cbegin(); iter != anyof->follows.cend(); ++iter) {
+                    if(std::find(follows.cbegin(), follows.cend(), fmap[*iter]) == follows.cend()) {
+                        follows.push_back(fmap[*iter]);
+                    }
+                }
+
+                return new NFAOptAnyOf(nid, follows);
+            }
+            case NFAOptTag::Star: {
+                const NFAOptStar* star = static_cast<const NFAOptStar*>(opt);
+                return new NFAOptStar(nid, fmap[star->matchfollow], fmap[star->skipfollow]);
+            }
+            case NFAOptTag::RangeK: {
+                const NFAOptRangeK* rngk = static_cast<const NFAOptRangeK*>(opt);
+                return new NFAOptRangeK(nid, rngk->mink, rngk->maxk, fmap[rngk->infollow], fmap[rngk->outfollow]);
+            }
+            default: {
+                return new NFAOptAccept(nid);
+            }
+        }
+    }
+
+    void NFAOptimizer::replaceStates(std::vector<NFAOpt*>& states, std::vector<NFAOpt*>& nstates)
+    {
+        for(auto iter = states.begin(); iter != states.end(); ++iter) {
+            delete *iter;
+        }
+
+        states.swap(nstates);
+        nstates.clear();
+    }
+
+    StateID NFAOptimizer::collapseEpsilonChains(StateID startstate, std::vector<NFAOpt*>& states)
+    {
+        //the non-AnyOf states that each AnyOf reaches through (nested) AnyOfs -- in order and without duplicates
+        std::vector<std::vector<StateID>> expanded(states.size());
+        for(StateID s = 0; s < states.size(); ++s) {
+            if(states[s]->tag != NFAOptTag::AnyOf) {
+                continue;
+            }
+
+            std::vector<bool> visited(states.size(), false);
+            std::vector<StateID> pending = { s };
+            visited[s] = true;
+            while(!pending.empty()) {
+                const NFAOptAnyOf* anyof = static_cast<const NFAOptAnyOf*>(states[pending.back()]);
+                pending.pop_back();
+
+                //push in reverse so the follows are expanded in order
+                for(auto iter = anyof->follows.crbegin(); iter != anyof->follows.crend(); ++iter) {
+                    if(visited[*iter]) {
+                        continue;
+                    }
+                    visited[*iter] = true;
+
+                    if(states[*iter]->tag == NFAOptTag::AnyOf) {
+                        pending.push_back(*iter);
+                    }
+                    else {
+                        expanded[s].push_back(*iter);
+                    }
+                }
+            }
+
+            std::reverse(expanded[s].begin(), expanded[s].end());
+        }
+
+        //an AnyOf with a single choice is just an edge to it
+        std::vector<StateID> target(states.size());
+        for(StateID s = 0; s < states.size(); ++s) {
+            target[s] = (states[s]->tag == NFAOptTag::AnyOf && expanded[s].size() == 1) ? expanded[s][0] : s;
+        }
+
+        std::vector<NFAOpt*> nstates;
+        for(StateID s = 0; s < states.size(); ++s) {
+            if(states[s]->tag == NFAOptTag::AnyOf) {
+                nstates.push_back(new NFAOptAnyOf(s, expanded[s]));
+            }
+            else {
+                nstates.push_back(NFAOptimizer::remapOpt(states[s], s, target));
+            }
+        }
+
+        NFAOptimizer::replaceStates(states, nstates);
+        return target[startstate];
+    }
+
+    StateID NFAOptimizer::mergeBisimilarStates(StateID startstate, std::vector<NFAOpt*>& states)
+    {
+        //partition refinement -- start with all states in one class and split by the kind/test of a state and the classes of its follows until nothing changes
+        std::vector<size_t> classof(states.size(), 0);
+        size_t classcount = 1;
+        while(true) {
+            std::map<std::vector<int64_t>, size_t> keys;
+            std::vector<size_t> nclassof(states.size(), 0);
+            for(StateID s = 0; s < states.size(); ++s) {
+                const NFAOpt* opt = states[s];
+
+                std::vector<int64_t> key = { (int64_t)opt->tag };
+                switch(opt->tag) {
+                    case NFAOptTag::CharCode: {
+                        key.push_back(static_cast<const NFAOptCharCode*>(opt)->c);
+                        break;
+                    }
+                    case NFAOptTag::CharRange: {
+                        const NFAOptRange* range = static_cast<const NFAOptRange*>(opt);
+                        key.push_back(range->compliment);
+                        for(auto iter = range->ranges.cbegin(); iter != range->ranges.cend(); ++iter) {
+                            key.push_back(iter->low);
+                            key.push_back(iter->high);
+                        }
+                        key.push_back(-1);
+                        break;
+                    }
+                    case NFAOptTag::RangeK: {
+                        key.push_back(s);
+                        break;
+                    }
+                    default: {
+                        break;
+                    }
+                }
+
+                std::vector<StateID> follows = NFAOptimizer::followsOf(opt);
+                std::vector<int64_t> fclasses;
+                std::transform(follows.cbegin(), follows.cend(), std::back_inserter(fclasses), [&classof](StateID f) { return (int64_t)classof[f]; });
+                if(opt->tag == NFAOptTag::AnyOf) {
+                    std::sort(fclasses.begin(), fclasses.end());
+                    fclasses.erase(std::unique(fclasses.begin(), fclasses.end()), fclasses.end());
+                }
+                std::copy(fclasses.cbegin(), fclasses.cend(), std::back_inserter(key));
+
+                auto ii = keys.find(key);
+                if(ii == keys.end()) {
+                    ii = keys.insert({ key, keys.size() }).first;
+                }
+                nclassof[s] = ii->second;
+            }
+
+            //classes are only ever split so the same count means the same partition
+            const bool stable = (keys.size() == classcount);
+            classof = nclassof;
+            classcount = keys.size();
+            if(stable) {
+                break;
+            }
+        }
+
+        //the smallest state in each class represents it (so the accept state stays 0)
+        std::vector<StateID> repof(classcount, (StateID)states.size());
+        for(StateID s = 0; s < states.size(); ++s) {
+            repof[classof[s]] = std::min(repof[classof[s]], s);
+        }
+
+        std::vector<StateID> fmap(states.size());
+        for(StateID s = 0; s < states.size(); ++s) {
+            fmap[s] = repof[classof[s]];
+        }
+
+        //the states that are not representatives are no longer referenced and are removed by the unreachable pass
+        std::vector<NFAOpt*> nstates;
+        for(StateID s = 0; s < states.size(); ++s) {
+            nstates.push_back(NFAOptimizer::remapOpt(states[s], s, fmap));
+        }
+
+        NFAOptimizer::replaceStates(states, nstates);
+        return fmap[startstate];
+    }
+
+    StateID NFAOptimizer::removeUnreachableStates(StateID startstate, std::vector<NFAOpt*>& states)
+    {
+        const StateID unreached = (StateID)states.size();
+
+        std::vector<StateID> order = { 0 };
+        std::vector<StateID> newid(states.size(), unreached);
+        newid[0] = 0;
+        if(newid[startstate] == unreached) {
+            newid[startstate] = (StateID)order.size();
+            order.push_back(startstate);
+        }
+
+        for(size_t i = 0; i < order.size(); ++i) {
+            std::vector<StateID> follows = NFAOptimizer::followsOf(states[order[i]]);
+            for(auto iter = follows.cbegin(); iter != follows.cend(); ++iter) {
+                if(newid[*iter] == unreached) {
+                    newid[*iter] = (StateID)order.size();
+                    order.push_back(*iter);
+                }
+            }
+        }
+
+        std::vector<NFAOpt*> nstates;
+        for(size_t i = 0; i < order.size(); ++i) {
+            nstates.push_back(NFAOptimizer::remapOpt(states[order[i]], (StateID)i, newid));
+        }
+
+        NFAOptimizer::replaceStates(states, nstates);
+        return newid[startstate];
+    }
+
+    StateID NFAOptimizer::optimize(StateID startstate, std::vector<NFAOpt*>& states)
+    {
+        startstate = NFAOptimizer::collapseEpsilonChains(startstate, states);
+        startstate = NFAOptimizer::mergeBisimilarStates(startstate, states);
+        return NFAOptimizer::removeUnreachableStates(startstate, states);
+    }
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include "../common.h"
+
+#include "nfa_machine.h"
+
+namespace brex
+{
+    //Cleanup passes over the states emitted by the compiler -- each pass replaces (and frees) the states it rewrites and returns the new start state
+    //The accept state stays at 0 and the result is numbered in BFS order from the start state
+    class NFAOptimizer
+    {
+    private:
+        static std::vector<StateID> followsOf(const NFAOpt* opt);
+
+        //a copy of opt as state nid with each follow f replaced by fmap[f] (and duplicate AnyOf follows dropped)
+        static NFAOpt* remapOpt(const NFAOpt* opt, StateID nid, const std::vector<StateID>& fmap);
+
+        //free the states and replace them with nstates
+        static void replaceStates(std::vector<NFAOpt*>& states, std::vector<NFAOpt*>& nstates);
+
+        //flatten AnyOfs that follow other AnyOfs, drop duplicate follows, and skip over AnyOfs with a single follow
+        static StateID collapseEpsilonChains(StateID startstate, std::vector<NFAOpt*>& states);
+
+        //merge states with the same test/kind whose follows are (recursively) equivalent -- RangeKs are never merged as tokens use them to identify their counters
+        static StateID mergeBisimilarStates(StateID startstate, std::vector<NFAOpt*>& states);
+
+        //drop the states that are not reachable from the start state and renumber the others in BFS order
+        static StateID removeUnreachableStates(StateID startstate, std::vector<NFAOpt*>& states);
+
+    public:
+        static StateID optimize(StateID startstate, std::vector<NFAOpt*>& states);
+    };
+}
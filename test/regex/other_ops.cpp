@@ -34,6 +34,22 @@ BOOST_AUTO_TEST_CASE(abc) {
     auto ustr = brex::UnicodeString(u8"abcdef");
     BOOST_CHECK(executor->testFront(&ustr, err));
 }
+BOOST_AUTO_TEST_CASE(allofanchor) {
+    brex::ExecutorError err;
+    auto texecutor = tryParseForUnicodeOtherOp(u8"/<[a-z0-9]+ & [a-z]+[0-9]* & !(.*\"x\"[0-9]*)>$\".\"/");
+
+    BOOST_CHECK(texecutor.has_value());
+
+    //the candidate ends of the AllOf are written into the executor scratch buffer and then checked against the anchor
+    auto executor = texecutor.value();
+    auto ustr = brex::UnicodeString(u8"ab12.c");
+    auto xstr = brex::UnicodeString(u8"ax12.c");
+    auto mstr = brex::UnicodeString(u8"ab12c");
+
+    BOOST_CHECK(executor->testFront(&ustr, err));
+    BOOST_CHECK(!executor->testFront(&xstr, err));
+    BOOST_CHECK(!executor->testFront(&mstr, err));
+}
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE(EndsWith)
@@ -47,6 +63,19 @@ BOOST_AUTO_TEST_CASE(abc) {
     auto ustr = brex::UnicodeString(u8"abcdef");
     BOOST_CHECK(executor->testBack(&ustr, err));
 }
+BOOST_AUTO_TEST_CASE(allofnot) {
+    brex::ExecutorError err;
+    auto texecutor = tryParseForUnicodeOtherOp(u8"/[a-z]+ & !(.*\"b\")/");
+
+    BOOST_CHECK(texecutor.has_value());
+    
+    auto executor = texecutor.value();
+    auto ustr = brex::UnicodeString(u8"ab");
+    BOOST_CHECK(!executor->testBack(&ustr, err));
+
+    auto mstr = brex::UnicodeString(u8"bba");
+    BOOST_CHECK(executor->testBack(&mstr, err));
+}
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE(Contains)
@@ -60,6 +89,127 @@ BOOST_AUTO_TEST_CASE(abc) {
     auto ustr = brex::UnicodeString(u8"abcdef");
     BOOST_CHECK(executor->testContains(&ustr, err));
 }
+BOOST_AUTO_TEST_CASE(emptyinput) {
+    brex::ExecutorError err;
+    auto texecutor = tryParseForUnicodeOtherOp(u8"/[a-c]?/");
+
+    BOOST_CHECK(texecutor.has_value());
+
+    //an empty input has no start position for a match -- a non-empty one contains the empty match
+    auto executor = texecutor.value();
+    auto estr = brex::UnicodeString(u8"");
+    BOOST_CHECK(!executor->testContains(&estr, err));
+    BOOST_CHECK(!executor->matchContainsFirst(&estr, err).has_value());
+
+    auto ustr = brex::UnicodeString(u8"x");
+    BOOST_CHECK(executor->testContains(&ustr, err));
+}
+BOOST_AUTO_TEST_CASE(longmiss) {
+    brex::ExecutorError err;
+    auto texecutor = tryParseForUnicodeOtherOp(u8"/\"err\"[0-9]{3}/");
+
+    BOOST_CHECK(texecutor.has_value());
+
+    auto executor = texecutor.value();
+    auto ustr = brex::UnicodeString(std::u8string(5000, u8'e') + u8"err12");
+    BOOST_CHECK(!executor->testContains(&ustr, err));
+
+    auto mstr = brex::UnicodeString(std::u8string(5000, u8'e') + u8"err123");
+    BOOST_CHECK(executor->testContains(&mstr, err));
+}
+BOOST_AUTO_TEST_CASE(literalwindows) {
+    brex::ExecutorError err;
+    auto texecutor = tryParseForUnicodeOtherOp(u8"/[0-9]{1,2}(\"err\"|\"erR\")\"or\"[0-9]?/");
+
+    BOOST_CHECK(texecutor.has_value());
+
+    auto executor = texecutor.value();
+    std::u8string decoys;
+    for(size_t i = 0; i < 500; ++i) {
+        decoys += u8"é1erRo x9err ";
+    }
+
+    auto ustr = brex::UnicodeString(decoys);
+    BOOST_CHECK(!executor->testContains(&ustr, err));
+
+    auto mstr = brex::UnicodeString(decoys + u8"x12erRor34" + decoys + u8"5error");
+    BOOST_CHECK(executor->testContains(&mstr, err));
+
+    auto rf = executor->matchContainsFirst(&mstr, err);
+    auto rl = executor->matchContainsLast(&mstr, err);
+    const int64_t mpos = (int64_t)decoys.size() + 1;
+    BOOST_CHECK(rf.has_value() && rf.value().first == mpos && rf.value().second == mpos + 7);
+    BOOST_CHECK(rl.has_value() && rl.value().first == (int64_t)mstr.size() - 6 && rl.value().second == (int64_t)mstr.size() - 1);
+}
+BOOST_AUTO_TEST_CASE(unboundedwindow) {
+    brex::ExecutorError err;
+    auto texecutor = tryParseForUnicodeOtherOp(u8"/\"E\"[0-9]{2,}/");
+
+    BOOST_CHECK(texecutor.has_value());
+
+    //an unbounded repeat must not limit the window around the literal -- the match is longer than UINT16_MAX chars
+    auto executor = texecutor.value();
+    auto ustr = brex::UnicodeString(u8"xE" + std::u8string(70000, u8'7') + u8"x");
+    auto rf = executor->matchContainsFirst(&ustr, err);
+    auto rl = executor->matchContainsLast(&ustr, err);
+
+    BOOST_CHECK(rf.has_value() && rf.value().first == 1 && rf.value().second == 70001);
+    BOOST_CHECK(rl.has_value() && rl.value().first == 1 && rl.value().second == 70001);
+}
+BOOST_AUTO_TEST_CASE(firstcharscan) {
+    brex::ExecutorError err;
+    auto texecutor = tryParseForUnicodeOtherOp(u8"/[0-9][a-z]|[α-γ][0-9]/");
+
+    BOOST_CHECK(texecutor.has_value());
+
+    auto executor = texecutor.value();
+    std::u8string filler;
+    for(size_t i = 0; i < 200; ++i) {
+        filler += u8"ABC é1 δ9 xyz.";
+    }
+
+    auto ustr = brex::UnicodeString(filler);
+    BOOST_CHECK(!executor->testContains(&ustr, err));
+
+    auto mstr = brex::UnicodeString(filler + u8"3q" + filler + u8"β7");
+    BOOST_CHECK(executor->testContains(&mstr, err));
+
+    auto rf = executor->matchContainsFirst(&mstr, err);
+    auto rl = executor->matchContainsLast(&mstr, err);
+    BOOST_CHECK(rf.has_value() && rf.value().first == (int64_t)filler.size() && rf.value().second == (int64_t)filler.size() + 1);
+    BOOST_CHECK(rl.has_value() && rl.value().first == (int64_t)mstr.size() - 3 && rl.value().second == (int64_t)mstr.size() - 1);
+}
+BOOST_AUTO_TEST_CASE(firstcharcontinuation) {
+    brex::ExecutorError err;
+    auto texecutor = tryParseForUnicodeOtherOp(u8"/[a-é]/");
+    auto bexecutor = tryParseForUnicodeOtherOp(u8"/[a-é]\"b\"/");
+
+    BOOST_CHECK(texecutor.has_value());
+    BOOST_CHECK(bexecutor.has_value());
+
+    //the lead bytes of [a-é] span 0x61-0xC3 -- the continuation bytes of € (0x82 0xAC) fall inside that span but can never start a match
+    auto executor = texecutor.value();
+    auto ustr = brex::UnicodeString(u8"€");
+    BOOST_CHECK(!executor->testContains(&ustr, err));
+    BOOST_CHECK(!executor->matchContainsFirst(&ustr, err).has_value());
+
+    auto bstr = brex::UnicodeString(u8"€b");
+    BOOST_CHECK(!bexecutor.value()->testContains(&bstr, err));
+    BOOST_CHECK(!bexecutor.value()->matchContainsFirst(&bstr, err).has_value());
+
+    std::u8string filler;
+    for(size_t i = 0; i < 200; ++i) {
+        filler += u8"€b€€ €";
+    }
+
+    auto lstr = brex::UnicodeString(filler);
+    BOOST_CHECK(!bexecutor.value()->testContains(&lstr, err));
+
+    auto mstr = brex::UnicodeString(filler + u8"éb" + filler);
+    auto rf = bexecutor.value()->matchContainsFirst(&mstr, err);
+    BOOST_CHECK(bexecutor.value()->testContains(&mstr, err));
+    BOOST_CHECK(rf.has_value() && rf.value().first == (int64_t)filler.size() && rf.value().second == (int64_t)filler.size() + 2);
+}
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE(StartsMatch)
@@ -99,6 +249,54 @@ BOOST_AUTO_TEST_CASE(anchorno) {
 
     BOOST_CHECK(!rr.has_value());
 }
+BOOST_AUTO_TEST_CASE(allof) {
+    brex::ExecutorError err;
+    auto texecutor = tryParseForUnicodeOtherOp(u8"/[a-z0-9]+ & [a-z]+[0-9]* & .*[0-9]/");
+
+    BOOST_CHECK(texecutor.has_value());
+    
+    auto executor = texecutor.value();
+    auto ustr = brex::UnicodeString(u8"ab12c3");
+    auto rr = executor->matchFront(&ustr, err);
+
+    BOOST_CHECK(rr.has_value() && rr.value() == 3);
+
+    auto rb = executor->matchBack(&ustr, err);
+    BOOST_CHECK(rb.has_value() && rb.value() == 4);
+}
+BOOST_AUTO_TEST_CASE(resultmodes) {
+    auto texecutor = tryParseForUnicodeOtherOp(u8"/[0-9]+/");
+
+    BOOST_CHECK(texecutor.has_value());
+    
+    auto executor = texecutor.value();
+    auto ustr = brex::UnicodeString(u8"123a456");
+
+    std::vector<int64_t> matches{ 9, 9, 9, 9 };
+    executor->re->matchFrontInto(&ustr, 0, 6, matches);
+    BOOST_CHECK(matches == std::vector<int64_t>({ 0, 1, 2 }));
+
+    executor->re->matchBackInto(&ustr, 0, 6, matches);
+    BOOST_CHECK(matches == std::vector<int64_t>({ 6, 5, 4 }));
+
+    auto rl = executor->re->matchFrontLongest(&ustr, 0, 6);
+    BOOST_CHECK(rl.has_value() && rl.value() == 2);
+
+    auto rb = executor->re->matchBackLongest(&ustr, 0, 6);
+    BOOST_CHECK(rb.has_value() && rb.value() == 4);
+
+    BOOST_CHECK(!executor->re->matchFrontLongest(&ustr, 3, 6).has_value());
+
+    auto single = dynamic_cast<brex::SingleCheckREInfo<brex::UnicodeString, brex::UnicodeRegexIterator>*>(executor->re);
+    BOOST_CHECK(single != nullptr);
+
+    auto rs = single->executor.matchForwardShortest(&ustr, 4, 6);
+    BOOST_CHECK(rs.has_value() && rs.value() == 4);
+
+    std::vector<int64_t> visited;
+    single->executor.visitForward(&ustr, 0, 6, [&visited](int64_t pos) { visited.push_back(pos); return visited.size() < 2; });
+    BOOST_CHECK(visited == std::vector<int64_t>({ 0, 1 }));
+}
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE(EndsMatch)
@@ -114,6 +312,40 @@ BOOST_AUTO_TEST_CASE(repeat09) {
 
     BOOST_CHECK(rr.has_value() && rr.value() == 4);
 }
+BOOST_AUTO_TEST_CASE(multibyte) {
+    brex::ExecutorError err;
+    auto texecutor = tryParseForUnicodeOtherOp(u8"/\"é\"[a-zé]?/");
+
+    BOOST_CHECK(texecutor.has_value());
+
+    auto executor = texecutor.value();
+    auto ustr = brex::UnicodeString(u8"aéé");
+    auto rr = executor->matchBack(&ustr, err);
+    auto rc = executor->matchContainsLast(&ustr, err);
+
+    BOOST_CHECK(executor->testBack(&ustr, err));
+    BOOST_CHECK(rr.has_value() && rr.value() == 1);
+    BOOST_CHECK(rc.has_value() && rc.value().first == 1 && rc.value().second == 3);
+}
+BOOST_AUTO_TEST_CASE(allofcounters) {
+    brex::ExecutorError err;
+    auto texecutor = tryParseForUnicodeOtherOp(u8"/\"a\"{0,3}[a1]{3,6} & [^a][a-b](\"a\"+[a1]*)*/");
+
+    BOOST_CHECK(texecutor.has_value());
+
+    //the counters keep these out of a product DFA so the (decreasing) reverse matches of each check are intersected
+    auto executor = texecutor.value();
+    auto ustr = brex::UnicodeString(u8"1aa1");
+    auto rr = executor->matchBack(&ustr, err);
+    auto rf = executor->matchFront(&ustr, err);
+
+    BOOST_CHECK(executor->testBack(&ustr, err));
+    BOOST_CHECK(rr.has_value() && rr.value() == 0);
+    BOOST_CHECK(executor->testBack(&ustr, 1, 3, err) == false);
+
+    BOOST_CHECK(executor->testFront(&ustr, err));
+    BOOST_CHECK(rf.has_value() && rf.value() == 3);
+}
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE(ContainsMatch)
@@ -129,6 +361,365 @@ BOOST_AUTO_TEST_CASE(repeata09) {
 
     BOOST_CHECK(rr.has_value() && rr.value().first == 3 && rr.value().second == 4);
 }
+BOOST_AUTO_TEST_CASE(overlapping) {
+    brex::ExecutorError err;
+    auto texecutor = tryParseForUnicodeOtherOp(u8"/[0-9]+\"-\"[0-9]+/");
+
+    BOOST_CHECK(texecutor.has_value());
+
+    auto executor = texecutor.value();
+    auto ustr = brex::UnicodeString(std::u8string(3000, u8'-') + u8"12-34-5" + std::u8string(3000, u8'x'));
+    auto rf = executor->matchContainsFirst(&ustr, err);
+    auto rl = executor->matchContainsLast(&ustr, err);
+
+    BOOST_CHECK(rf.has_value() && rf.value().first == 3000 && rf.value().second == 3004);
+    BOOST_CHECK(rl.has_value() && rl.value().first == 3003 && rl.value().second == 3006);
+}
+BOOST_AUTO_TEST_CASE(leftmost) {
+    brex::ExecutorError err;
+    auto texecutor = tryParseForUnicodeOtherOp(u8"/\"a\".*\"z\"|\"b\"/");
+
+    BOOST_CHECK(texecutor.has_value());
+
+    auto executor = texecutor.value();
+    auto ustr = brex::UnicodeString(u8"zaab-bbab-bbz-za");
+    auto rf = executor->matchContainsFirst(&ustr, err);
+    auto rl = executor->matchContainsLast(&ustr, err);
+
+    BOOST_CHECK(rf.has_value() && rf.value().first == 1 && rf.value().second == 14);
+    BOOST_CHECK(rl.has_value() && rl.value().first == 1 && rl.value().second == 14);
+}
+BOOST_AUTO_TEST_CASE(counters) {
+    brex::ExecutorError err;
+    auto texecutor = tryParseForUnicodeOtherOp(u8"/[0-9]{3}/");
+
+    BOOST_CHECK(texecutor.has_value());
+
+    auto executor = texecutor.value();
+    auto ustr = brex::UnicodeString(std::u8string(3000, u8'x') + u8"12345" + std::u8string(3000, u8'y') + u8"678" + std::u8string(3000, u8'z'));
+    auto rf = executor->matchContainsFirst(&ustr, err);
+    auto rl = executor->matchContainsLast(&ustr, err);
+
+    BOOST_CHECK(rf.has_value() && rf.value().first == 3000 && rf.value().second == 3002);
+    BOOST_CHECK(rl.has_value() && rl.value().first == 6005 && rl.value().second == 6007);
+
+    auto rexecutor = tryParseForUnicodeOtherOp(u8"/\"a\"{2,4}/");
+    BOOST_CHECK(rexecutor.has_value());
+
+    auto astr = brex::UnicodeString(u8"aaaaaa-aaa");
+    auto af = rexecutor.value()->matchContainsFirst(&astr, err);
+    auto al = rexecutor.value()->matchContainsLast(&astr, err);
+
+    BOOST_CHECK(af.has_value() && af.value().first == 0 && af.value().second == 3);
+    BOOST_CHECK(al.has_value() && al.value().first == 7 && al.value().second == 9);
+}
+BOOST_AUTO_TEST_CASE(nullablecounter) {
+    brex::ExecutorError err;
+    auto texecutor = tryParseForUnicodeOtherOp(u8"/((\"a\")*){2,}\"b\"?/");
+
+    BOOST_CHECK(texecutor.has_value());
+
+    //the group search on a machine with counters merges the tokens of the groups -- with a body that matches empty this used to be tens of thousands of tokens a step
+    auto executor = texecutor.value();
+    auto ustr = brex::UnicodeString(u8"xx" + std::u8string(200, u8'a') + u8"b-");
+    auto rf = executor->matchContainsFirst(&ustr, err);
+    auto rl = executor->matchContainsLast(&ustr, err);
+
+    BOOST_CHECK(rf.has_value() && rf.value().first == 2 && rf.value().second == 202);
+    BOOST_CHECK(rl.has_value() && rl.value().first == 2 && rl.value().second == 202);
+    BOOST_CHECK(executor->testContains(&ustr, err));
+}
+BOOST_AUTO_TEST_CASE(findall) {
+    brex::ExecutorError err;
+    auto texecutor = tryParseForUnicodeOtherOp(u8"/[0-9]+/");
+
+    BOOST_CHECK(texecutor.has_value());
+
+    auto executor = texecutor.value();
+    auto ustr = brex::UnicodeString(u8"ab12cdé345e6");
+
+    std::vector<std::pair<int64_t, int64_t>> spans;
+    for(auto span : executor->findAll(&ustr, err)) {
+        spans.push_back(span);
+    }
+    BOOST_CHECK((spans == std::vector<std::pair<int64_t, int64_t>>({ {2, 3}, {8, 10}, {12, 12} })));
+
+    std::u8string filler;
+    for(size_t i = 0; i < 5000; ++i) {
+        filler += u8"x12 ";
+    }
+
+    auto lstr = brex::UnicodeString(filler);
+    size_t count = 0;
+    for(auto span : executor->findAll(&lstr, err)) {
+        BOOST_CHECK(span.first == (int64_t)(count * 4) + 1 && span.second == (int64_t)(count * 4) + 2);
+        count++;
+    }
+    BOOST_CHECK(count == 5000);
+}
+BOOST_AUTO_TEST_CASE(findallmultibyte) {
+    brex::ExecutorError err;
+    auto texecutor = tryParseForUnicodeOtherOp(u8"/[^a]+/");
+
+    BOOST_CHECK(texecutor.has_value());
+
+    //the end of a match is the first byte of its last char so the next search has to skip the rest of it
+    auto executor = texecutor.value();
+    auto ustr = brex::UnicodeString(u8"é🌵aébaé");
+
+    std::vector<std::pair<int64_t, int64_t>> spans;
+    for(auto span : executor->findAll(&ustr, err)) {
+        spans.push_back(span);
+    }
+    BOOST_CHECK((spans == std::vector<std::pair<int64_t, int64_t>>({ {0, 2}, {7, 9}, {11, 11} })));
+
+    auto cstr = brex::UnicodeString(u8"🌵");
+    spans.clear();
+    for(auto span : executor->findAll(&cstr, err)) {
+        spans.push_back(span);
+    }
+    BOOST_CHECK((spans == std::vector<std::pair<int64_t, int64_t>>({ {0, 0} })));
+}
+BOOST_AUTO_TEST_CASE(findallanchor) {
+    brex::ExecutorError err;
+    auto texecutor = tryParseForUnicodeOtherOp(u8"/<[0-9]+>$[a-z]/");
+
+    BOOST_CHECK(texecutor.has_value());
+
+    auto executor = texecutor.value();
+    auto ustr = brex::UnicodeString(u8"12a3 45b6");
+
+    std::vector<std::pair<int64_t, int64_t>> spans;
+    for(auto span : executor->findAll(&ustr, err)) {
+        spans.push_back(span);
+    }
+    BOOST_CHECK((spans == std::vector<std::pair<int64_t, int64_t>>({ {0, 1}, {5, 6} })));
+}
+BOOST_AUTO_TEST_CASE(findallrejected) {
+    brex::ExecutorError err;
+    auto texecutor = tryParseForUnicodeOtherOp(u8"/<[0-9]+>$[a-z]/");
+
+    BOOST_CHECK(texecutor.has_value());
+
+    //the post anchor rejects the first several matches (and the start of the last one is inside a rejected match)
+    auto executor = texecutor.value();
+    auto ustr = brex::UnicodeString(u8"1 22 333 4444x 55y");
+
+    std::vector<std::pair<int64_t, int64_t>> spans;
+    for(auto span : executor->findAll(&ustr, err)) {
+        spans.push_back(span);
+    }
+    BOOST_CHECK((spans == std::vector<std::pair<int64_t, int64_t>>({ {9, 12}, {15, 16} })));
+
+    auto mstr = brex::UnicodeString(u8"é1 2 33a 44");
+    spans.clear();
+    for(auto span : executor->findAll(&mstr, err)) {
+        spans.push_back(span);
+    }
+    BOOST_CHECK((spans == std::vector<std::pair<int64_t, int64_t>>({ {6, 7} })));
+}
+BOOST_AUTO_TEST_CASE(findallrejectedpre) {
+    brex::ExecutorError err;
+    auto texecutor = tryParseForUnicodeOtherOp(u8"/[a-z]^<[0-9]+>/");
+
+    BOOST_CHECK(texecutor.has_value());
+
+    //the pre anchor rejects the first several matches
+    auto executor = texecutor.value();
+    auto ustr = brex::UnicodeString(u8"1 2 3 a45 6 b7");
+
+    std::vector<std::pair<int64_t, int64_t>> spans;
+    for(auto span : executor->findAll(&ustr, err)) {
+        spans.push_back(span);
+    }
+    BOOST_CHECK((spans == std::vector<std::pair<int64_t, int64_t>>({ {7, 8}, {13, 13} })));
+
+    auto mstr = brex::UnicodeString(u8"1 2 3 45");
+    BOOST_CHECK(!executor->testContains(&mstr, err));
+}
+BOOST_AUTO_TEST_CASE(containsanchor) {
+    brex::ExecutorError err;
+    auto texecutor = tryParseForUnicodeOtherOp(u8"/[0-9]^<\"-\"[a-z]+>$\".\"/");
+
+    BOOST_CHECK(texecutor.has_value());
+
+    //the anchored composite has no search machines so contains searches re between the boundaries that the anchors accept
+    auto executor = texecutor.value();
+    auto ustr = brex::UnicodeString(u8"a-bc. 1-de 2-fg.");
+    auto mstr = brex::UnicodeString(u8"a-bc. 1-de 2-fg");
+
+    BOOST_CHECK(executor->testContains(&ustr, err));
+    BOOST_CHECK(!executor->testContains(&mstr, err));
+    BOOST_CHECK(executor->test(&ustr, 11, 15, err));
+}
+BOOST_AUTO_TEST_CASE(containsanchorcounters) {
+    brex::ExecutorError err;
+    auto texecutor = tryParseForUnicodeOtherOp(u8"/<[0-9]{2,3}>$\"a\"/");
+
+    BOOST_CHECK(texecutor.has_value());
+
+    auto executor = texecutor.value();
+    auto ustr = brex::UnicodeString(u8"123b 4567a 89a x");
+    auto rf = executor->matchContainsFirst(&ustr, err);
+    auto rl = executor->matchContainsLast(&ustr, err);
+
+    BOOST_CHECK(rf.has_value() && rf.value().first == 6 && rf.value().second == 8);
+    BOOST_CHECK(rl.has_value() && rl.value().first == 11 && rl.value().second == 12);
+
+    //the pre anchor rejects every match that ends in the last number so the earlier ends are checked
+    auto pexecutor = tryParseForUnicodeOtherOp(u8"/\"-\"^<[0-9]{2,3}>/");
+    BOOST_CHECK(pexecutor.has_value());
+
+    auto pstr = brex::UnicodeString(u8"-12 3456");
+    auto pf = pexecutor.value()->matchContainsFirst(&pstr, err);
+    auto pl = pexecutor.value()->matchContainsLast(&pstr, err);
+
+    BOOST_CHECK(pf.has_value() && pf.value().first == 1 && pf.value().second == 2);
+    BOOST_CHECK(pl.has_value() && pl.value().first == 1 && pl.value().second == 2);
+}
+BOOST_AUTO_TEST_CASE(containsanchorlong) {
+    brex::ExecutorError err;
+    auto texecutor = tryParseForUnicodeOtherOp(u8"/<[a-z]+>$\"x\"/");
+
+    BOOST_CHECK(texecutor.has_value());
+
+    //every position starts a match of re that the post anchor rejects -- the anchors mark the boundaries once so this is one pass and not a match from each start
+    auto executor = texecutor.value();
+    auto ustr = brex::UnicodeString(std::u8string(20000, u8'q'));
+    BOOST_CHECK(!executor->testContains(&ustr, err));
+    BOOST_CHECK(!executor->matchContainsFirst(&ustr, err).has_value());
+
+    auto mstr = brex::UnicodeString(std::u8string(20000, u8'q') + u8"x");
+    auto rf = executor->matchContainsFirst(&mstr, err);
+    BOOST_CHECK(executor->testContains(&mstr, err));
+    BOOST_CHECK(rf.has_value() && rf.value().first == 0 && rf.value().second == 19999);
+
+    //a match that ends in a multibyte char is checked against the anchor after the whole char
+    auto bexecutor = tryParseForUnicodeOtherOp(u8"/\"c\"^<[^c]{2,}>$\"c\"/");
+    BOOST_CHECK(bexecutor.has_value());
+
+    auto bstr = brex::UnicodeString(u8"c1€cxac€bcx");
+    auto bf = bexecutor.value()->matchContainsFirst(&bstr, err);
+    BOOST_CHECK(bf.has_value() && bf.value().first == 1 && bf.value().second == 2);
+}
+BOOST_AUTO_TEST_CASE(containsanchorlonglast) {
+    brex::ExecutorError err;
+    auto texecutor = tryParseForUnicodeOtherOp(u8"/\"x\"^<[a-z]+>/");
+
+    BOOST_CHECK(texecutor.has_value());
+
+    //every position ends a match of re that the pre anchor rejects -- the same single pass as the first match but from the end
+    auto executor = texecutor.value();
+    auto ustr = brex::UnicodeString(std::u8string(20000, u8'q'));
+    BOOST_CHECK(!executor->matchContainsLast(&ustr, err).has_value());
+
+    auto mstr = brex::UnicodeString(u8"x" + std::u8string(20000, u8'q'));
+    auto rl = executor->matchContainsLast(&mstr, err);
+    BOOST_CHECK(rl.has_value() && rl.value().first == 1 && rl.value().second == 20000);
+
+    auto bexecutor = tryParseForUnicodeOtherOp(u8"/\"c\"^<[^c]{2,}>$\"c\"/");
+    BOOST_CHECK(bexecutor.has_value());
+
+    auto bstr = brex::UnicodeString(u8"xécb€c€é2bay");
+    auto bl = bexecutor.value()->matchContainsLast(&bstr, err);
+    BOOST_CHECK(bl.has_value() && bl.value().first == 4 && bl.value().second == 5);
+}
+BOOST_AUTO_TEST_CASE(containscounterlong) {
+    brex::ExecutorError err;
+    auto texecutor = tryParseForUnicodeOtherOp(u8"/[a-z]{3,1000}\" \"[0-9]/");
+
+    BOOST_CHECK(texecutor.has_value());
+
+    //a match is at most 1002 chars so the search machines find the span -- not a group of counters for every start
+    auto executor = texecutor.value();
+    auto ustr = brex::UnicodeString(u8"€" + std::u8string(3000, u8'q') + u8" 1" + std::u8string(3000, u8'q') + u8" 2");
+    auto rf = executor->matchContainsFirst(&ustr, err);
+    BOOST_CHECK(rf.has_value() && rf.value().first == 2003 && rf.value().second == 3004);
+
+    auto rl = executor->matchContainsLast(&ustr, err);
+    BOOST_CHECK(rl.has_value() && rl.value().first == 5005 && rl.value().second == 6006);
+
+    std::vector<std::pair<int64_t, int64_t>> spans;
+    for(auto span : executor->findAll(&ustr, err)) {
+        spans.push_back(span);
+    }
+    BOOST_CHECK((spans == std::vector<std::pair<int64_t, int64_t>>({ {2003, 3004}, {5005, 6006} })));
+
+    auto nstr = brex::UnicodeString(std::u8string(10000, u8'q'));
+    BOOST_CHECK(!executor->matchContainsFirst(&nstr, err).has_value());
+    BOOST_CHECK(!executor->matchContainsLast(&nstr, err).has_value());
+}
+BOOST_AUTO_TEST_CASE(replace) {
+    brex::ExecutorError err;
+    auto texecutor = tryParseForUnicodeOtherOp(u8"/[0-9]+/");
+
+    BOOST_CHECK(texecutor.has_value());
+
+    auto executor = texecutor.value();
+    auto ustr = brex::UnicodeString(u8"ab12cdé345e6");
+
+    brex::UnicodeString out;
+    auto rall = executor->replaceAll(&ustr, u8"#", out, err);
+    BOOST_CHECK(rall == 3 && out == u8"ab#cdé#e#");
+
+    auto rfirst = executor->replaceFirst(&ustr, u8"<num>", out, err);
+    BOOST_CHECK(rfirst == 1 && out == u8"ab<num>cdé345e6");
+
+    auto nstr = brex::UnicodeString(u8"abc");
+    auto rnone = executor->replaceAll(&nstr, u8"#", out, err);
+    BOOST_CHECK(rnone == 0 && out == u8"abc");
+}
+BOOST_AUTO_TEST_CASE(replacemultibyte) {
+    brex::ExecutorError err;
+    auto texecutor = tryParseForUnicodeOtherOp(u8"/\"é\"+/");
+
+    BOOST_CHECK(texecutor.has_value());
+
+    //the matches end in a multibyte char so all of its bytes are replaced
+    auto executor = texecutor.value();
+    auto ustr = brex::UnicodeString(u8"éé");
+
+    brex::UnicodeString out;
+    auto rall = executor->replaceAll(&ustr, u8"#", out, err);
+    BOOST_CHECK(rall == 1 && out == u8"#");
+
+    auto mstr = brex::UnicodeString(u8"aééb🌵é");
+    rall = executor->replaceAll(&mstr, u8"#", out, err);
+    BOOST_CHECK(rall == 2 && out == u8"a#b🌵#");
+
+    auto rfirst = executor->replaceFirst(&mstr, u8"<e>", out, err);
+    BOOST_CHECK(rfirst == 1 && out == u8"a<e>b🌵é");
+}
+BOOST_AUTO_TEST_CASE(split) {
+    brex::ExecutorError err;
+    auto texecutor = tryParseForUnicodeOtherOp(u8"/[ ,]+/");
+
+    BOOST_CHECK(texecutor.has_value());
+
+    auto executor = texecutor.value();
+    auto ustr = brex::UnicodeString(u8"a, bc,,d ");
+
+    std::vector<std::pair<int64_t, int64_t>> parts;
+    executor->split(&ustr, parts, err);
+    BOOST_CHECK((parts == std::vector<std::pair<int64_t, int64_t>>({ {0, 0}, {3, 4}, {7, 7}, {9, 8} })));
+}
+BOOST_AUTO_TEST_CASE(splitmultibyte) {
+    brex::ExecutorError err;
+    auto texecutor = tryParseForUnicodeOtherOp(u8"/\"é\"+/");
+
+    BOOST_CHECK(texecutor.has_value());
+
+    auto executor = texecutor.value();
+    auto ustr = brex::UnicodeString(u8"aééb🌵é");
+
+    std::vector<std::pair<int64_t, int64_t>> parts;
+    executor->split(&ustr, parts, err);
+    BOOST_CHECK((parts == std::vector<std::pair<int64_t, int64_t>>({ {0, 0}, {5, 9}, {12, 11} })));
+
+    auto estr = brex::UnicodeString(u8"éé");
+    executor->split(&estr, parts, err);
+    BOOST_CHECK((parts == std::vector<std::pair<int64_t, int64_t>>({ {0, -1}, {4, 3} })));
+}
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
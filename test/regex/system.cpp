@@ -2,6 +2,8 @@
 
 #include "../../src/regex/brex_system.h"
 
+#include <thread>
+
 BOOST_AUTO_TEST_SUITE(System)
 
 BOOST_AUTO_TEST_SUITE(Single)
@@ -195,4 +197,85 @@ BOOST_AUTO_TEST_CASE(abcabc) {
 }
 BOOST_AUTO_TEST_SUITE_END()
 
+BOOST_AUTO_TEST_SUITE(Shared)
+BOOST_AUTO_TEST_CASE(contexts) {
+    brex::RENSInfo ninfo = {
+        {
+            "Main",
+            {}
+        },
+        {
+            {
+                "Num",
+                u8"/<[0-9]+>$\" \"/"
+            },
+            {
+                "Five",
+                u8"/[0-9]+ & [0-9]*\"5\"[0-9]*/"
+            },
+            {
+                "Word",
+                u8"/[a-z]+/"
+            }
+        }
+    };
+
+    std::vector<brex::RENSInfo> ninfos = { ninfo };
+    std::vector<std::u8string> errors;
+    auto sys = brex::ReSystem::processSystem(ninfos, errors);
+
+    BOOST_CHECK(errors.empty());
+
+    std::u8string text;
+    for(size_t i = 0; i < 500; ++i) {
+        text += u8"ab 151 x9 ";
+    }
+
+    //each thread matches with its own contexts over the shared compiled system
+    std::vector<size_t> numcounts(4, 0);
+    std::vector<size_t> wordcounts(4, 0);
+    std::vector<size_t> fivecounts(4, 0);
+    std::vector<std::thread> workers;
+    for(size_t t = 0; t < 4; ++t) {
+        workers.push_back(std::thread([&sys, &text, &numcounts, &wordcounts, &fivecounts, t]() {
+            auto numctx = sys.createUnicodeREContext("Main::Num");
+            auto wordctx = sys.createUnicodeREContext("Main::Word");
+            auto fivectx = sys.createUnicodeREContext("Main::Five");
+
+            brex::UnicodeString ustr = text;
+            brex::UnicodeString fstr = u8"151";
+            brex::UnicodeString nstr = u8"161";
+            brex::ExecutorError err = brex::ExecutorError::Ok;
+            for(size_t rep = 0; rep < 10; ++rep) {
+                fivecounts[t] += (fivectx->test(&fstr, err) && !fivectx->test(&nstr, err)) ? 1 : 0;
+
+                numcounts[t] = 0;
+                for(auto span : numctx->findAll(&ustr, err)) {
+                    numcounts[t] += (span.second - span.first == 2) ? 1 : 0;
+                }
+
+                wordcounts[t] = 0;
+                for(auto span : wordctx->findAll(&ustr, err)) {
+                    wordcounts[t] += (span.second >= span.first) ? 1 : 0;
+                }
+            }
+
+            delete numctx;
+            delete wordctx;
+            delete fivectx;
+        }));
+    }
+
+    for(auto iter = workers.begin(); iter != workers.end(); ++iter) {
+        iter->join();
+    }
+
+    for(size_t t = 0; t < 4; ++t) {
+        BOOST_CHECK(numcounts[t] == 500);
+        BOOST_CHECK(wordcounts[t] == 1000);
+        BOOST_CHECK(fivecounts[t] == 10);
+    }
+}
+BOOST_AUTO_TEST_SUITE_END()
+
 BOOST_AUTO_TEST_SUITE_END()
\ No newline at end of file
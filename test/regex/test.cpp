@@ -212,6 +212,28 @@ BOOST_AUTO_TEST_CASE(complimentemoji) {
     ACCEPTS_TEST_UNICODE(executor, u8"🌵", false);
     ACCEPTS_TEST_UNICODE(executor, u8"🌶", false);
 }
+BOOST_AUTO_TEST_CASE(multipage) {
+    auto texecutor = tryParseForUnicodeTest(u8"/[À-ʯ]+/");
+    BOOST_CHECK(texecutor.has_value());
+
+    auto executor = texecutor.value();
+    ACCEPTS_TEST_UNICODE(executor, u8"À", true);
+    ACCEPTS_TEST_UNICODE(executor, u8"ÿĀƐʯ", true);
+    ACCEPTS_TEST_UNICODE(executor, u8"¿", false);
+    ACCEPTS_TEST_UNICODE(executor, u8"Āʰ", false);
+    ACCEPTS_TEST_UNICODE(executor, u8"Ā🌵", false);
+}
+BOOST_AUTO_TEST_CASE(overlapcompliment) {
+    auto texecutor = tryParseForUnicodeTest(u8"/[^ʯ-ʰa-zÀ-ʯb]+/");
+    BOOST_CHECK(texecutor.has_value());
+
+    auto executor = texecutor.value();
+    ACCEPTS_TEST_UNICODE(executor, u8"A", true);
+    ACCEPTS_TEST_UNICODE(executor, u8"¿ʱ🌵", true);
+    ACCEPTS_TEST_UNICODE(executor, u8"b", false);
+    ACCEPTS_TEST_UNICODE(executor, u8"Aʰ", false);
+    ACCEPTS_TEST_UNICODE(executor, u8"ÀA", false);
+}
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE(C)
@@ -327,6 +349,27 @@ BOOST_AUTO_TEST_CASE(comborng) {
     ACCEPTS_TEST_UNICODE(executor, u8"4🌶", true);
     ACCEPTS_TEST_UNICODE(executor, u8"ab", false);
 }
+BOOST_AUTO_TEST_CASE(manystates) {
+    auto texecutor = tryParseForUnicodeTest(u8"/.*\"a\"............/");
+    BOOST_CHECK(texecutor.has_value());
+
+    //long pseudo-random a/b strings -- the 13 positions fit the bit-parallel engine (the lazy DFA cache is covered by DFABudget/lazycache)
+    std::u8string sa;
+    uint32_t seed = 7;
+    for(size_t i = 0; i < 20000; ++i) {
+        seed = seed * 1103515245 + 12345;
+        sa.push_back((seed & 0x10000) ? u8'a' : u8'b');
+    }
+    std::u8string sb = sa;
+    sa[sa.size() - 13] = u8'a';
+    sb[sb.size() - 13] = u8'b';
+
+    auto executor = texecutor.value();
+    ACCEPTS_TEST_UNICODE(executor, sa, true);
+    ACCEPTS_TEST_UNICODE(executor, sb, false);
+    ACCEPTS_TEST_UNICODE(executor, u8"abbbbbbbbbbbb", true);
+    ACCEPTS_TEST_UNICODE(executor, u8"abbbbbbbbbbbbb", false);
+}
 BOOST_AUTO_TEST_SUITE_END()
 
 BOOST_AUTO_TEST_SUITE(C)
@@ -413,6 +456,19 @@ BOOST_AUTO_TEST_CASE(absplit) {
     ACCEPTS_TEST_UNICODE(executor, u8"aab", false);
     ACCEPTS_TEST_UNICODE(executor, u8"", true);
 }
+BOOST_AUTO_TEST_CASE(trailingdot) {
+    auto texecutor = tryParseForUnicodeTest(u8"/[a-z]{1,300}\"!\".*/");
+    BOOST_CHECK(texecutor.has_value());
+
+    auto executor = texecutor.value();
+    ACCEPTS_TEST_UNICODE(executor, u8"ab!", true);
+    ACCEPTS_TEST_UNICODE(executor, u8"ab!!x🌵", true);
+    ACCEPTS_TEST_UNICODE(executor, u8"ab!" + std::u8string(1000, u8'7'), true);
+
+    ACCEPTS_TEST_UNICODE(executor, u8"ab", false);
+    ACCEPTS_TEST_UNICODE(executor, u8"!ab", false);
+    ACCEPTS_TEST_UNICODE(executor, u8"7ab!", false);
+}
 BOOST_AUTO_TEST_CASE(abs) {
     auto texecutor = tryParseForUnicodeTest(u8"/\"a\"\"b\"*/");
     BOOST_CHECK(texecutor.has_value());
@@ -718,6 +774,112 @@ BOOST_AUTO_TEST_CASE(both) {
     ACCEPTS_TEST_UNICODE(executor, u8"aa", false);
     ACCEPTS_TEST_UNICODE(executor, u8"1234", false);
 }
+BOOST_AUTO_TEST_CASE(alternation) {
+    auto texecutor = tryParseForUnicodeTest(u8"/(\"ab\"|\"a\"){2,3}/");
+    BOOST_CHECK(texecutor.has_value());
+
+    auto executor = texecutor.value();
+
+    ACCEPTS_TEST_UNICODE(executor, u8"", false);
+    ACCEPTS_TEST_UNICODE(executor, u8"a", false);
+    ACCEPTS_TEST_UNICODE(executor, u8"aa", true);
+    ACCEPTS_TEST_UNICODE(executor, u8"aba", true);
+    ACCEPTS_TEST_UNICODE(executor, u8"ababab", true);
+    ACCEPTS_TEST_UNICODE(executor, u8"aaaa", false);
+    ACCEPTS_TEST_UNICODE(executor, u8"abb", false);
+}
+BOOST_AUTO_TEST_CASE(wide) {
+    auto texecutor = tryParseForUnicodeTest(u8"/[0-9]{3,100}\"x\"/");
+    BOOST_CHECK(texecutor.has_value());
+
+    auto executor = texecutor.value();
+
+    ACCEPTS_TEST_UNICODE(executor, u8"12x", false);
+    ACCEPTS_TEST_UNICODE(executor, u8"123x", true);
+    ACCEPTS_TEST_UNICODE(executor, u8"123", false);
+    ACCEPTS_TEST_UNICODE(executor, std::u8string(100, u8'7') + u8"x", true);
+    ACCEPTS_TEST_UNICODE(executor, std::u8string(101, u8'7') + u8"x", false);
+}
+BOOST_AUTO_TEST_CASE(nested) {
+    auto texecutor = tryParseForUnicodeTest(u8"/([0-9]{1,3}\".\"){3}[0-9]{1,3}/");
+    BOOST_CHECK(texecutor.has_value());
+
+    auto executor = texecutor.value();
+
+    ACCEPTS_TEST_UNICODE(executor, u8"10.0.0.1", true);
+    ACCEPTS_TEST_UNICODE(executor, u8"192.168.100.255", true);
+    ACCEPTS_TEST_UNICODE(executor, u8"10.0.1", false);
+    ACCEPTS_TEST_UNICODE(executor, u8"10.0.0.0.1", false);
+    ACCEPTS_TEST_UNICODE(executor, u8"1000.0.0.1", false);
+}
+BOOST_AUTO_TEST_CASE(large) {
+    auto texecutor = tryParseForUnicodeTest(u8"/[a-z]*\"x\"[a-z]{500,2000}\"!\"/");
+    BOOST_CHECK(texecutor.has_value());
+
+    auto executor = texecutor.value();
+
+    ACCEPTS_TEST_UNICODE(executor, u8"x" + std::u8string(500, u8'a') + u8"!", true);
+    ACCEPTS_TEST_UNICODE(executor, u8"x" + std::u8string(499, u8'a') + u8"!", false);
+    ACCEPTS_TEST_UNICODE(executor, u8"x" + std::u8string(2000, u8'a') + u8"!", true);
+    ACCEPTS_TEST_UNICODE(executor, u8"x" + std::u8string(2001, u8'a') + u8"!", false);
+    ACCEPTS_TEST_UNICODE(executor, u8"x" + std::u8string(1000, u8'a') + u8"x" + std::u8string(1500, u8'a') + u8"!", true);
+    ACCEPTS_TEST_UNICODE(executor, u8"x" + std::u8string(2100, u8'a') + u8"x" + std::u8string(100, u8'a') + u8"!", false);
+}
+BOOST_AUTO_TEST_CASE(sharedbody) {
+    auto texecutor = tryParseForUnicodeTest(u8"/(\"b\"|\"ab\")(\"b\"|\"ab\"){300,400}/");
+    BOOST_CHECK(texecutor.has_value());
+
+    auto executor = texecutor.value();
+
+    ACCEPTS_TEST_UNICODE(executor, std::u8string(301, u8'b'), true);
+    ACCEPTS_TEST_UNICODE(executor, std::u8string(300, u8'b'), false);
+    ACCEPTS_TEST_UNICODE(executor, u8"ab" + std::u8string(400, u8'b'), true);
+    ACCEPTS_TEST_UNICODE(executor, u8"ab" + std::u8string(401, u8'b'), false);
+    ACCEPTS_TEST_UNICODE(executor, u8"ab" + std::u8string(200, u8'b') + u8"ab" + std::u8string(199, u8'b'), true);
+    ACCEPTS_TEST_UNICODE(executor, u8"ab" + std::u8string(200, u8'b') + u8"aab" + std::u8string(199, u8'b'), false);
+}
+BOOST_AUTO_TEST_CASE(nestedwide) {
+    auto texecutor = tryParseForUnicodeTest(u8"/([a-z]{1,100}\"-\"){2,3}/");
+    BOOST_CHECK(texecutor.has_value());
+
+    auto executor = texecutor.value();
+
+    ACCEPTS_TEST_UNICODE(executor, u8"a-b-", true);
+    ACCEPTS_TEST_UNICODE(executor, u8"a-" + std::u8string(100, u8'q') + u8"-c-", true);
+    ACCEPTS_TEST_UNICODE(executor, u8"a-", false);
+    ACCEPTS_TEST_UNICODE(executor, u8"a-b-c-d-", false);
+    ACCEPTS_TEST_UNICODE(executor, u8"a-" + std::u8string(101, u8'q') + u8"-", false);
+}
+BOOST_AUTO_TEST_CASE(nullablebody) {
+    auto texecutor = tryParseForUnicodeTest(u8"/((\"a\")?){2,}\"b\"/");
+    BOOST_CHECK(texecutor.has_value());
+
+    auto executor = texecutor.value();
+
+    ACCEPTS_TEST_UNICODE(executor, u8"b", true);
+    ACCEPTS_TEST_UNICODE(executor, u8"aaaaab", true);
+    ACCEPTS_TEST_UNICODE(executor, u8"aaaaa", false);
+
+    //the body matches empty so the count of the unbounded range would climb to UINT16_MAX in one closure if it did not stop at mink
+    auto single = dynamic_cast<brex::SingleCheckREInfo<brex::UnicodeString, brex::UnicodeRegexIterator>*>(executor->re);
+    BOOST_CHECK(single != nullptr);
+
+    brex::NFAState nstates;
+    brex::NFAEpsilonWorkSet workset;
+    brex::NFAEpsilonFixpointSet fixpoint;
+    single->executor.forwardMachine()->intitializeMachine(nstates, workset, fixpoint);
+    BOOST_CHECK(nstates.stateSize() < 16);
+
+    //nested ranges keep a full token for the outer (unbounded) range
+    auto nexecutor = tryParseForUnicodeTest(u8"/((\"a\"){0,2}\"-\"?){3,}\"b\"/");
+    BOOST_CHECK(nexecutor.has_value());
+
+    executor = nexecutor.value();
+
+    ACCEPTS_TEST_UNICODE(executor, u8"b", true);
+    ACCEPTS_TEST_UNICODE(executor, u8"aaa-a--aaaab", true);
+    ACCEPTS_TEST_UNICODE(executor, u8"aaa-a--aaaa", false);
+}
 BOOST_AUTO_TEST_SUITE_END()
 
 
@@ -932,6 +1094,30 @@ BOOST_AUTO_TEST_CASE(ii) {
     ACCEPTS_TEST_UNICODE(executor, u8"6", true);
     ACCEPTS_TEST_UNICODE(executor, u8"3", false);
 }
+BOOST_AUTO_TEST_CASE(iii) {
+    auto texecutor = tryParseForUnicodeTest(u8"/[a-z0-9]{2,6} & [a-z]+[0-9]* & .*[0-9] & !(\"ab\".*)/");
+    BOOST_CHECK(texecutor.has_value());
+    
+    auto executor = texecutor.value();
+
+    ACCEPTS_TEST_UNICODE(executor, u8"abc1", false);
+    ACCEPTS_TEST_UNICODE(executor, u8"xyz12", true);
+    ACCEPTS_TEST_UNICODE(executor, u8"x1", true);
+    ACCEPTS_TEST_UNICODE(executor, u8"xyz", false);
+    ACCEPTS_TEST_UNICODE(executor, u8"1xyz2", false);
+    ACCEPTS_TEST_UNICODE(executor, u8"xyzw123", false);
+}
+BOOST_AUTO_TEST_CASE(inotnot) {
+    auto texecutor = tryParseForUnicodeTest(u8"/[a-z.]+ & !(.*\".tmp\") & !(\"x\".*)/");
+    BOOST_CHECK(texecutor.has_value());
+    
+    auto executor = texecutor.value();
+
+    ACCEPTS_TEST_UNICODE(executor, u8"a.txt", true);
+    ACCEPTS_TEST_UNICODE(executor, u8"a.tmp", false);
+    ACCEPTS_TEST_UNICODE(executor, u8"x.txt", false);
+    ACCEPTS_TEST_UNICODE(executor, u8"a.tmp.txt", true);
+}
 BOOST_AUTO_TEST_SUITE_END()
 
 ////
@@ -1002,4 +1188,338 @@ BOOST_AUTO_TEST_CASE(notbob) {
 }
 BOOST_AUTO_TEST_SUITE_END()
 
+////
+//PrePostAnchor
+BOOST_AUTO_TEST_SUITE(PrePostAnchor)
+BOOST_AUTO_TEST_CASE(both) {
+    auto texecutor = tryParseForUnicodeTest(u8"/[0-9]+^<\"-\"[a-z]+>$\".\"[a-z]{2,3}/");
+
+    BOOST_CHECK(texecutor.has_value());
+    
+    auto executor = texecutor.value();
+    ACCEPTS_TEST_UNICODE(executor, u8"12-abc.txt", true);
+    ACCEPTS_TEST_UNICODE(executor, u8"12-abc.t", false);
+    ACCEPTS_TEST_UNICODE(executor, u8"-abc.txt", false);
+    ACCEPTS_TEST_UNICODE(executor, u8"12-.txt", false);
+}
+BOOST_AUTO_TEST_CASE(postonly) {
+    auto texecutor = tryParseForUnicodeTest(u8"/<[a-z]+>$\"!\"/");
+
+    BOOST_CHECK(texecutor.has_value());
+    
+    auto executor = texecutor.value();
+    ACCEPTS_TEST_UNICODE(executor, u8"12 abc!", true);
+    ACCEPTS_TEST_UNICODE(executor, u8"abc! ", false);
+    ACCEPTS_TEST_UNICODE(executor, u8"12 !", false);
+}
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(SimpleStateSet)
+BOOST_AUTO_TEST_CASE(insertclear) {
+    brex::NFASimpleStateSet sset(8);
+    BOOST_CHECK(sset.empty());
+
+    sset.insert(5);
+    sset.insert(2);
+    sset.insert(5);
+    sset.insert(7);
+    BOOST_CHECK(sset.size() == 3);
+    BOOST_CHECK(sset.contains(2) && sset.contains(5) && sset.contains(7));
+    BOOST_CHECK(!sset.contains(0) && !sset.contains(6));
+    BOOST_CHECK((std::vector<brex::StateID>(sset.cbegin(), sset.cend()) == std::vector<brex::StateID>({ 5, 2, 7 })));
+
+    //the stale sparse entries left by a clear must not make states look present
+    sset.clear();
+    BOOST_CHECK(sset.empty());
+    BOOST_CHECK(!sset.contains(2) && !sset.contains(5) && !sset.contains(7));
+
+    sset.insert(7);
+    BOOST_CHECK(sset.size() == 1 && sset.contains(7) && !sset.contains(5));
+
+    sset.resize(16);
+    BOOST_CHECK(sset.empty());
+    sset.insert(15);
+    BOOST_CHECK(sset.contains(15) && !sset.contains(7));
+}
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(Reuse)
+BOOST_AUTO_TEST_CASE(repeated) {
+    std::vector<std::u8string> regexes = { u8"/[a-z]+[0-9]{2,4}/", u8"/(\"ab\"|\"a\")*\"c\"/", u8"/[α-γ]+[0-9]*/" };
+    std::vector<std::u8string> strs = { u8"abc123", u8"abc1", u8"ababac", u8"abab", u8"αβ12", u8"α🌵", u8"", u8"zz9999" };
+
+    for(auto riter = regexes.cbegin(); riter != regexes.cend(); ++riter) {
+        auto texecutor = tryParseForUnicodeTest(*riter);
+        BOOST_CHECK(texecutor.has_value());
+
+        //the scratch states of one executor are reused for every op so interleaving ops and inputs must give the same results as the first run
+        auto executor = texecutor.value();
+        std::vector<bool> expected;
+        for(size_t rep = 0; rep < 5; ++rep) {
+            std::vector<bool> results;
+            for(auto siter = strs.cbegin(); siter != strs.cend(); ++siter) {
+                auto ustr = brex::UnicodeString(*siter);
+                brex::ExecutorError err;
+                results.push_back(executor->test(&ustr, err));
+                results.push_back(executor->testContains(&ustr, err));
+                results.push_back(executor->matchFront(&ustr, err).has_value());
+            }
+
+            if(rep == 0) {
+                expected = results;
+            }
+            BOOST_CHECK(results == expected);
+        }
+
+        //and the same results as running each op on a new executor
+        std::vector<bool> fresh;
+        for(auto siter = strs.cbegin(); siter != strs.cend(); ++siter) {
+            auto ustr = brex::UnicodeString(*siter);
+            brex::ExecutorError err;
+            fresh.push_back(tryParseForUnicodeTest(*riter).value()->test(&ustr, err));
+            fresh.push_back(tryParseForUnicodeTest(*riter).value()->testContains(&ustr, err));
+            fresh.push_back(tryParseForUnicodeTest(*riter).value()->matchFront(&ustr, err).has_value());
+        }
+        BOOST_CHECK(fresh == expected);
+    }
+}
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(Program)
+BOOST_AUTO_TEST_CASE(assemble) {
+    std::vector<brex::NFAOpt*> opts = {
+        new brex::NFAOptRange(0, true, { {'a', 'c'} }, 3),
+        new brex::NFAOptRange(1, false, { {0x3B1, 0x3B3}, {'0', '9'} }, 3),
+        new brex::NFAOptRange(2, true, { {0x3B1, 0x3B3} }, 3),
+        new brex::NFAOptAnyOf(3, { 0, 1, 2 }),
+        new brex::NFAOptAnyOf(4, { 5 }),
+        new brex::NFAOptCharCode(5, 'x', 6),
+        new brex::NFAOptAccept(6)
+    };
+
+    auto program = brex::NFAProgram::assemble(opts);
+    std::for_each(opts.begin(), opts.end(), [](brex::NFAOpt* opt) { delete opt; });
+
+    BOOST_CHECK(program.size() == 7);
+    BOOST_CHECK(program.follows[0] == 3 && program.follows[1] == 3 && program.follows[5] == 6);
+
+    //complemented ascii range
+    BOOST_CHECK(!program.charTest(0, 'a') && !program.charTest(0, 'b') && !program.charTest(0, 'c'));
+    BOOST_CHECK(program.charTest(0, 'd') && program.charTest(0, '0') && program.charTest(0, 0x3B1));
+
+    //non-ascii and ascii ranges given out of order
+    BOOST_CHECK(program.charTest(1, 0x3B1) && program.charTest(1, 0x3B2) && program.charTest(1, 0x3B3) && program.charTest(1, '5'));
+    BOOST_CHECK(!program.charTest(1, 0x3B0) && !program.charTest(1, 0x3B4) && !program.charTest(1, 'a'));
+
+    //complemented non-ascii range
+    BOOST_CHECK(!program.charTest(2, 0x3B2));
+    BOOST_CHECK(program.charTest(2, 0x3B0) && program.charTest(2, 0x3B4) && program.charTest(2, 'a') && program.charTest(2, 0x1F335));
+
+    BOOST_CHECK((std::vector<brex::StateID>(program.anyofFollowsBegin(3), program.anyofFollowsEnd(3)) == std::vector<brex::StateID>({ 0, 1, 2 })));
+    BOOST_CHECK((std::vector<brex::StateID>(program.anyofFollowsBegin(4), program.anyofFollowsEnd(4)) == std::vector<brex::StateID>({ 5 })));
+
+    BOOST_CHECK(program.charTest(5, 'x') && !program.charTest(5, 'y'));
+    BOOST_CHECK(!program.concreteTransition(3) && !program.concreteTransition(4) && program.concreteTransition(5));
+}
+BOOST_AUTO_TEST_CASE(charclasses) {
+    std::vector<brex::NFAOpt*> opts = {
+        new brex::NFAOptRange(0, false, { {'a', 0xE9} }, 1),
+        new brex::NFAOptCharCode(1, 0x20AC, 2),
+        new brex::NFAOptAccept(2)
+    };
+
+    auto program = brex::NFAProgram::assemble(opts);
+    std::for_each(opts.begin(), opts.end(), [](brex::NFAOpt* opt) { delete opt; });
+
+    auto classes = brex::CharClassMap::build(program);
+    BOOST_CHECK(classes.classcount() == 5);
+    BOOST_CHECK(classes.classOf('A') == 0 && classes.classOf('b') == 1 && classes.classOf(0xE9) == 1 && classes.classOf(0xEA) == 2);
+    BOOST_CHECK(classes.classOf(0x100) == 2 && classes.classOf(0x20AB) == 2 && classes.classOf(0x20AC) == 3 && classes.classOf(0x20AD) == 4);
+    BOOST_CHECK(classes.classOf(0x20FF) == 4 && classes.classOf(0x2100) == 4 && classes.classOf(0x1F335) == 4);
+
+    //pages only go up to the page of the largest boundary (and hold 16 bit ids) -- a shared uniform page and the page of the euro sign
+    BOOST_CHECK(classes.footprint() < 2048);
+    BOOST_CHECK(classes.separates(program));
+
+    std::vector<brex::NFAOpt*> aopts = {
+        new brex::NFAOptRange(0, false, { {'a', 'z'} }, 1),
+        new brex::NFAOptAccept(1)
+    };
+
+    auto aprogram = brex::NFAProgram::assemble(aopts);
+    std::for_each(aopts.begin(), aopts.end(), [](brex::NFAOpt* opt) { delete opt; });
+
+    //an ascii only regex just has the byte table
+    auto aclasses = brex::CharClassMap::build(aprogram);
+    BOOST_CHECK(aclasses.footprint() < 512);
+    BOOST_CHECK(aclasses.classOf('q') == 1 && aclasses.classOf(0x20AC) == 2);
+
+    BOOST_CHECK(classes.separates(aprogram) == false && brex::CharClassMap::build({ &program, &aprogram }).separates(aprogram));
+}
+BOOST_AUTO_TEST_SUITE_END()
+
+BOOST_AUTO_TEST_SUITE(DFABudget)
+std::optional<brex::UnicodeRegexExecutor*> tryParseForUnicodeBudgetTest(const std::u8string& str, size_t budget) {
+    auto pr = brex::RegexParser::parseUnicodeRegex(str, false);
+    if(!pr.first.has_value() || !pr.second.empty()) {
+        return std::nullopt;
+    }
+
+    std::map<std::string, const brex::RegexOpt*> namemap;
+    std::map<std::string, const brex::LiteralOpt*> envmap;
+    std::vector<brex::RegexCompileError> compileerror;
+    auto executor = brex::RegexCompiler::compileUnicodeRegexToExecutor(pr.first.value(), namemap, envmap, false, nullptr, nullptr, compileerror, budget);
+    if(!compileerror.empty()) {
+        return std::nullopt;
+    }
+
+    return std::make_optional(executor);
+}
+
+const brex::NFAMachine* forwardMachineOf(brex::UnicodeRegexExecutor* executor) {
+    auto single = dynamic_cast<brex::SingleCheckREInfo<brex::UnicodeString, brex::UnicodeRegexIterator>*>(executor->re);
+    return single != nullptr ? single->executor.forwardMachine() : nullptr;
+}
+
+BOOST_AUTO_TEST_CASE(compile) {
+    auto texecutor = tryParseForUnicodeBudgetTest(u8"/(\"a\"|\"b\")*\"abb\"/", DFA_STATE_BUDGET);
+    BOOST_CHECK(texecutor.has_value());
+
+    auto m = forwardMachineOf(texecutor.value());
+    BOOST_CHECK(m != nullptr);
+
+    //a budget of 0 disables compilation and a budget below the number of subset states gives up
+    BOOST_CHECK(brex::DFAMachine::tryCompile(m, 0) == nullptr);
+    BOOST_CHECK(brex::DFAMachine::tryCompile(m, 4) == nullptr);
+
+    //the minimal DFA for (a|b)*abb has 4 states plus the dead state
+    auto dfa = brex::DFAMachine::tryCompile(m, 5);
+    BOOST_CHECK(dfa != nullptr && dfa->statecount() == 5);
+
+    //equivalent regexes minimize to the same number of states
+    auto eexecutor = tryParseForUnicodeBudgetTest(u8"/(\"a\"*\"b\"*)*\"a\"\"b\"\"b\"/", DFA_STATE_BUDGET);
+    auto edfa = brex::DFAMachine::tryCompile(forwardMachineOf(eexecutor.value()), DFA_STATE_BUDGET);
+    BOOST_CHECK(edfa != nullptr && edfa->statecount() == dfa->statecount());
+
+    //machines with counters are never compiled
+    auto cexecutor = tryParseForUnicodeBudgetTest(u8"/[a-z]{2,5}/", DFA_STATE_BUDGET);
+    BOOST_CHECK(brex::DFAMachine::tryCompile(forwardMachineOf(cexecutor.value()), DFA_STATE_BUDGET) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(footprint) {
+    auto texecutor = tryParseForUnicodeBudgetTest(u8"/[a-z]+\"@\"[a-z]+\".com\"/", DFA_DEFAULT_STATE_BUDGET);
+    BOOST_CHECK(texecutor.has_value());
+
+    //the program is moved into the machine without spare capacity -- a state is a tag, a follow, and an operand plus the two range sets
+    auto m = forwardMachineOf(texecutor.value());
+    const auto& program = m->program;
+    BOOST_CHECK(program.footprint() == (program.size() * (sizeof(brex::NFAOptTag) + sizeof(brex::StateID) + sizeof(uint32_t))) + (program.rangesets.size() * sizeof(brex::NFAProgramRangeSet)) + (program.ranges.size() * sizeof(brex::SingleCharRange)) + (program.followlists.size() * sizeof(brex::StateID)));
+    BOOST_CHECK(m->footprint() < 1024);
+
+    auto cexecutor = tryParseForUnicodeBudgetTest(u8"/[0-9]{1,3}(\".\"[0-9]{1,3}){3}/", DFA_DEFAULT_STATE_BUDGET);
+    BOOST_CHECK(cexecutor.has_value());
+    BOOST_CHECK(forwardMachineOf(cexecutor.value())->footprint() < 2048);
+}
+
+BOOST_AUTO_TEST_CASE(lazycache) {
+    //each of the alternated chars is in a char class of its own (so the 1MB lazy cache only holds ~1K states) and they make the regex too big for the bit-parallel engine
+    std::u8string re = u8"/(.*\"a\"............)";
+    for(uint32_t c = 0x400; c < 0x500; ++c) {
+        re += u8"|\"";
+        re.push_back((char8_t)(0xC0 | (c >> 6)));
+        re.push_back((char8_t)(0x80 | (c & 0x3F)));
+        re += u8"\"";
+    }
+    re += u8"/";
+
+    //the AOT DFA would need far more than the default budget of states anyway so a budget of 0 just skips trying to build it
+    auto texecutor = tryParseForUnicodeBudgetTest(re, 0);
+    BOOST_CHECK(texecutor.has_value());
+
+    auto executor = texecutor.value();
+    auto m = forwardMachineOf(executor);
+
+    auto classes = std::make_shared<const brex::CharClassMap>(brex::CharClassMap::build(m->program));
+    BOOST_CHECK(classes->classcount() > 256);
+
+    //pseudo-random a/b strings visit a new DFA state at almost every step
+    auto randomab = [](size_t len, bool accept) {
+        std::u8string str;
+        uint32_t seed = 7;
+        for(size_t i = 0; i < len; ++i) {
+            seed = seed * 1103515245 + 12345;
+            str.push_back((seed & 0x10000) ? u8'a' : u8'b');
+        }
+        str[str.size() - 13] = accept ? u8'a' : u8'b';
+        return str;
+    };
+
+    brex::LazyDFAMachine lazy(m, classes);
+    auto runlazy = [&lazy](const std::u8string& str) {
+        auto ustr = brex::UnicodeString(str);
+        brex::UnicodeRegexIterator iter(&ustr);
+        auto s = lazy.intitializeMachine();
+        while(iter.valid() && !lazy.gaveup()) {
+            s = lazy.stepMachine(s, iter.get());
+            iter.inc();
+        }
+        return lazy.inAccepted(s);
+    };
+
+    //a few thousand chars flush the cache but not often enough to give up
+    BOOST_CHECK(runlazy(randomab(3000, true)));
+    BOOST_CHECK(lazy.flushCount() > 0 && !lazy.gaveup());
+    BOOST_CHECK(!runlazy(randomab(3000, false)));
+    BOOST_CHECK(lazy.flushCount() > 0 && !lazy.gaveup());
+
+    //a long string thrashes the cache so the lazy DFA gives up
+    runlazy(randomab(8000, true));
+    BOOST_CHECK(lazy.gaveup());
+
+    //the executor gets the same results with a flushed cache and when it has to rerun the search on the NFA
+    ACCEPTS_TEST_UNICODE(executor, randomab(3000, true), true);
+    ACCEPTS_TEST_UNICODE(executor, randomab(3000, false), false);
+    ACCEPTS_TEST_UNICODE(executor, randomab(8000, true), true);
+    ACCEPTS_TEST_UNICODE(executor, randomab(8000, false), false);
+    ACCEPTS_TEST_UNICODE(executor, u8"Ѐ", true);
+}
+
+BOOST_AUTO_TEST_CASE(differential) {
+    std::vector<std::u8string> regexes = { u8"/(\"a\"|\"b\")*\"abb\"/", u8"/[a-z]+\"-\"[0-9]+/", u8"/\"x\"?[α-γ]*\"y\"/", u8"/([0-9]\"_\")*[0-9]/", u8"/[a-z]{2,4}[0-9]/", u8"/[a-z]+ & [a-c]*\"b\"[a-z]*/" };
+    std::vector<std::u8string> strs = { u8"", u8"abb", u8"aababb", u8"abab", u8"zz abb-12 abc-9 ", u8"xαβy", u8"αy xy", u8"1_2_3", u8"1__2", u8"ab9 abcde9", u8"cab", u8"ddd" };
+
+    //budget 0 (the default) runs on the bit-parallel/lazy DFA/NFA engines, a budget of 5 compiles only the smallest machines, and DFA_STATE_BUDGET compiles the rest
+    std::vector<size_t> budgets = { 0, 5, DFA_STATE_BUDGET };
+    for(auto riter = regexes.cbegin(); riter != regexes.cend(); ++riter) {
+        std::vector<std::vector<int64_t>> results;
+        for(auto biter = budgets.cbegin(); biter != budgets.cend(); ++biter) {
+            auto texecutor = tryParseForUnicodeBudgetTest(*riter, *biter);
+            BOOST_CHECK(texecutor.has_value());
+
+            auto executor = texecutor.value();
+            std::vector<int64_t> res;
+            for(auto siter = strs.cbegin(); siter != strs.cend(); ++siter) {
+                auto ustr = brex::UnicodeString(*siter);
+                brex::ExecutorError err;
+                res.push_back(executor->test(&ustr, err) ? 1 : 0);
+                res.push_back(executor->matchFront(&ustr, err).value_or(-2));
+                res.push_back(executor->matchBack(&ustr, err).value_or(-2));
+
+                if(executor->declre->canUseInContains()) {
+                    res.push_back(executor->testContains(&ustr, err) ? 1 : 0);
+
+                    auto first = executor->matchContainsFirst(&ustr, err);
+                    res.push_back(first.has_value() ? first->first : -2);
+                    res.push_back(first.has_value() ? first->second : -2);
+                }
+            }
+            results.push_back(res);
+        }
+
+        BOOST_CHECK(results[0] == results[1]);
+        BOOST_CHECK(results[0] == results[2]);
+    }
+}
+BOOST_AUTO_TEST_SUITE_END()
+
 BOOST_AUTO_TEST_SUITE_END()